@@ -0,0 +1,126 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "cecache.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// sets the key, and derives the name of the cache file from it
+CECache::CECache(const char *dir, bool forward, uint32_t num_of_CEs_, uint64_t seed, const struct in6_addr *bmr_ipv6_prefix, uint8_t bmr_ipv6_prefix_length,
+                 uint32_t bmr_ipv4_prefix, uint8_t bmr_ipv4_prefix_length, uint8_t bmr_EA_length)
+{
+  num_of_CEs = num_of_CEs_;
+  memset(&header, 0, sizeof(header)); // the padding bytes are hashed and compared, too
+  strncpy(header.magic, CE_CACHE_MAGIC, sizeof(header.magic));
+  header.key.version = CE_CACHE_VERSION;
+  header.key.ce_size = sizeof(CE_data);
+  header.key.bmr_ipv6_prefix = *bmr_ipv6_prefix;
+  header.key.bmr_ipv4_prefix = bmr_ipv4_prefix;
+  header.key.bmr_ipv6_prefix_length = bmr_ipv6_prefix_length;
+  header.key.bmr_ipv4_prefix_length = bmr_ipv4_prefix_length;
+  header.key.bmr_EA_length = bmr_EA_length;
+  header.key.forward = forward;
+  header.key.num_of_CEs = num_of_CEs;
+  header.key.seed = seed;
+
+  uint64_t hash = 14695981039346656037ULL; // FNV-1a
+  const uint8_t *k = (const uint8_t *)&header.key;
+  for (size_t i = 0; i < sizeof(header.key); i++)
+    hash = (hash ^ k[i]) * 1099511628211ULL;
+  snprintf(path, sizeof(path), "%s/ce-%016lx.bin", dir, hash);
+}
+
+// maps the CE array of the cache file, and copies it into the memory of the given NUMA node
+CE_data *CECache::load(int socket_id, const char *direction)
+{
+  CECacheHeader file_header;
+  struct stat st;
+  size_t size = (size_t)num_of_CEs * sizeof(CE_data);
+  CE_data *CE;
+  void *data;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL; // not cached yet
+  if (fstat(fd, &st) || (size_t)st.st_size != CE_CACHE_DATA + size ||
+      pread(fd, &file_header, sizeof(file_header), 0) != sizeof(file_header) || memcmp(&file_header, &header, sizeof(header)))
+  {
+    printf("Warning: the CE cache file '%s' of the %s sender is invalid, the CE array is built again\n", path, direction);
+    close(fd);
+    return NULL;
+  }
+  data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, CE_CACHE_DATA);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    printf("Warning: can not map the CE cache file '%s' of the %s sender, the CE array is built again\n", path, direction);
+    return NULL;
+  }
+  CE = (CE_data *)reserveCETable("array", direction, size, socket_id);
+  if (!CE)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for CEs data at the %s sender!\n", direction);
+  rte_memcpy(CE, data, size);
+  munmap(data, size);
+  printf("Info: the CE array of the %s sender was loaded from '%s'\n", direction, path);
+  return CE;
+}
+
+// writes the CE array into a temporary file, and renames it to the name of the cache file
+// (failures are reported, but the test is not affected by them)
+void CECache::save(const CE_data *CE, const char *direction)
+{
+  char tmp_path[PATH_MAX + 16];
+  uint8_t padded[CE_CACHE_DATA];
+  size_t size = (size_t)num_of_CEs * sizeof(CE_data);
+  int fd;
+  bool ok;
+
+  snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, getpid());
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    printf("Warning: can not create the CE cache file '%s' of the %s sender\n", tmp_path, direction);
+    return;
+  }
+  memset(padded, 0, sizeof(padded));
+  memcpy(padded, &header, sizeof(header));
+  ok = write(fd, padded, sizeof(padded)) == sizeof(padded);
+  for (size_t done = 0; ok && done < size;)
+  {
+    ssize_t n = write(fd, (const uint8_t *)CE + done, size - done);
+    ok = n > 0;
+    done += ok ? n : 0;
+  }
+  ok = !close(fd) && ok;
+  if (!ok || rename(tmp_path, path))
+  {
+    printf("Warning: can not write the CE cache file '%s' of the %s sender\n", path, direction);
+    unlink(tmp_path);
+    return;
+  }
+  printf("Info: the CE array of the %s sender was saved into '%s'\n", direction, path);
+}
@@ -0,0 +1,77 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CECACHE_H_INCLUDED
+#define CECACHE_H_INCLUDED
+
+#include <limits.h>
+
+// Persistent cache of the CE arrays (optional, see 'CE-cache' and 'CE-seed' in the configuration file)
+//
+// A CE array is built from a pseudorandom permutation of all the (2^suffix-2)*2^psid EA-bits combinations, which
+// takes seconds and many GB of memory with long EA-bits. If the permutation is seeded ('CE-seed' is not 0), the CE array
+// depends only on the MAP rule, the number of CEs, the seed and the direction, thus it is saved into the cache
+// directory, and the later runs with the same parameters load it instead of generating it again.
+// A cache file consists of a header (its key, padded to CE_CACHE_DATA bytes) and the CE_data array (with the precomputed
+// checksums). Its name contains the FNV-1a hash of the key, and it is used only if its size and the key in its header
+// match. The array is mapped by mmap() and copied into the hugepage memory of the NUMA node of the sender.
+// A new cache file is written under a temporary name first and then renamed, thus a partial file can not be loaded.
+
+#define CE_CACHE_MAGIC "MAPTCE"  // the first bytes of the cache files
+#define CE_CACHE_VERSION 2       // must be changed, if the layout of CE_data or the generation of the CE arrays changes
+#define CE_CACHE_DATA 4096       // the offset of the CE array in the cache files (page aligned for mmap())
+
+// the parameters the CE array of a direction depends on
+struct CECacheKey
+{
+  uint32_t version;                 // CE_CACHE_VERSION
+  uint32_t ce_size;                 // sizeof(CE_data)
+  struct in6_addr bmr_ipv6_prefix;
+  uint32_t bmr_ipv4_prefix;
+  uint8_t bmr_ipv6_prefix_length;
+  uint8_t bmr_ipv4_prefix_length;
+  uint8_t bmr_EA_length;
+  uint8_t forward;                  // 1: forward, 0: reverse direction
+  uint32_t num_of_CEs;
+  uint64_t seed;
+};
+
+struct CECacheHeader
+{
+  char magic[8];  // CE_CACHE_MAGIC
+  CECacheKey key;
+};
+
+class CECache
+{
+public:
+  CECache(const char *dir, bool forward, uint32_t num_of_CEs_, uint64_t seed, const struct in6_addr *bmr_ipv6_prefix, uint8_t bmr_ipv6_prefix_length,
+          uint32_t bmr_ipv4_prefix, uint8_t bmr_ipv4_prefix_length, uint8_t bmr_EA_length);
+  CE_data *load(int socket_id, const char *direction); // returns NULL, if there is no valid cache file
+  void save(const CE_data *CE, const char *direction);
+
+private:
+  CECacheHeader header;  // the header of the cache file (with the key)
+  uint32_t num_of_CEs;
+  char path[PATH_MAX];   // the name of the cache file
+};
+
+#endif
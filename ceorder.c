@@ -0,0 +1,148 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "ceorder.h"
+
+// samples the ranks [1, n] of a Zipf distribution with the given exponent (> 0) by rejection-inversion
+// W. Hormann, G. Derflinger: Rejection-inversion to generate variates from monotone discrete distributions,
+// ACM Transactions on Modeling and Computer Simulation, 6(3), 1996, pp. 169-184.
+class ZipfSampler
+{
+public:
+  ZipfSampler(uint32_t n_, double exponent_)
+  {
+    n = n_;
+    exponent = exponent_;
+    h_integral_x1 = hIntegral(1.5) - 1.0;
+    h_integral_n = hIntegral(n + 0.5);
+    s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+  }
+
+  template <class Rng>
+  uint32_t sample(Rng &rng)
+  {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    while (true)
+    {
+      double u = h_integral_n + uniform(rng) * (h_integral_x1 - h_integral_n);
+      double x = hIntegralInverse(u);
+      uint64_t k = x < 1.0 ? 1 : (uint64_t)(x + 0.5);
+      if (k > n)
+        k = n;
+      if (k - x <= s || u >= hIntegral(k + 0.5) - h(k))
+        return (uint32_t)k;
+    }
+  }
+
+private:
+  // the integral of h(x) = x^-exponent, shifted so that it is continuous at exponent = 1
+  double hIntegral(double x)
+  {
+    double log_x = log(x);
+    return helper2((1.0 - exponent) * log_x) * log_x;
+  }
+  double h(double x) { return exp(-exponent * log(x)); }
+  double hIntegralInverse(double x)
+  {
+    double t = x * (1.0 - exponent);
+    if (t < -1.0)
+      t = -1.0; // against rounding errors
+    return exp(helper1(t) * x);
+  }
+  // log1p(x)/x and expm1(x)/x, with their Taylor series near 0
+  static double helper1(double x) { return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x)); }
+  static double helper2(double x) { return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x)); }
+
+  uint32_t n;
+  double exponent;
+  double h_integral_x1, h_integral_n, s;
+};
+
+// generates the stream of CE indices of a direction in the memory of its senders
+CEOrder::CEOrder(int order, uint32_t num_of_CEs, double skew, double hot_ces, double hot_load, uint64_t seed, uint32_t stream,
+                 int socket_id, const char *direction_)
+{
+  uint64_t start, rounds = 0;
+  direction = direction_;
+  if (order == CE_ORDER_SHUFFLED)
+  {
+    rounds = (CE_ORDER_LENGTH + num_of_CEs - 1) / num_of_CEs;
+    length = (uint32_t)(rounds * num_of_CEs);
+  }
+  else
+    length = std::max(num_of_CEs, (uint32_t)CE_ORDER_LENGTH);
+  index = (uint32_t *)reserveCETable("order", direction, (size_t)length * sizeof(uint32_t), socket_id);
+  if (!index)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the CE order of the %s sender!\n", direction);
+
+  if (!seed)
+  {
+    std::random_device rd; // Will be used to obtain a seed
+    seed = ((uint64_t)rd() << 32) | rd();
+  }
+  std::mt19937_64 rng(seed ^ (0x9e3779b97f4a7c15 * (stream + 1))); // the streams of the same seed are different
+  start = rte_rdtsc();
+  switch (order)
+  {
+  case CE_ORDER_SHUFFLED:
+    for (uint32_t i = 0; i < num_of_CEs; i++)
+      index[i] = i;
+    for (uint64_t r = 0; r < rounds; r++)
+    {
+      uint32_t *round = index + r * num_of_CEs;
+      if (r)
+        rte_memcpy(round, round - num_of_CEs, (size_t)num_of_CEs * sizeof(uint32_t)); // shuffling the previous round gives a new permutation
+      std::shuffle(round, round + num_of_CEs, rng);
+    }
+    break;
+  case CE_ORDER_RANDOM:
+  {
+    std::uniform_int_distribution<uint32_t> uniform(0, num_of_CEs - 1);
+    for (uint32_t i = 0; i < length; i++)
+      index[i] = uniform(rng);
+    break;
+  }
+  case CE_ORDER_ZIPF:
+  {
+    ZipfSampler zipf(num_of_CEs, skew);
+    for (uint32_t i = 0; i < length; i++)
+      index[i] = zipf.sample(rng) - 1;
+    break;
+  }
+  default: // CE_ORDER_HOTSET
+  {
+    uint32_t hot = std::max((uint32_t)1, (uint32_t)(num_of_CEs * hot_ces / 100.0 + 0.5)); // the number of the hot CEs
+    std::uniform_real_distribution<double> coin(0.0, 100.0);
+    std::uniform_int_distribution<uint32_t> hot_set(0, hot - 1);
+    std::uniform_int_distribution<uint32_t> cold_set(std::min(hot, num_of_CEs - 1), num_of_CEs - 1);
+    for (uint32_t i = 0; i < length; i++)
+      index[i] = hot == num_of_CEs || coin(rng) < hot_load ? hot_set(rng) : cold_set(rng);
+  }
+  }
+  printf("Info: the CE order of the %s sender: %u positions generated in %.3lf seconds\n", direction, length, 1.0 * (rte_rdtsc() - start) / rte_get_timer_hz());
+}
+
+CEOrder::~CEOrder()
+{
+  freeCETable("order", direction);
+}
@@ -0,0 +1,68 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CEORDER_H_INCLUDED
+#define CEORDER_H_INCLUDED
+
+// The order of the CEs visited by the foreground frames (see 'CE-order' in the configuration file)
+//
+// In the sequential order, the k-th frame of a direction belongs to the (k % NUM-OF-CEs)-th CE, thus every CE gets the same
+// load in a fixed cyclic order, which is the friendliest possible pattern for the caches of the DUT. The other orders are
+// precomputed into a stream of CE indices (at least CE_ORDER_LENGTH positions, shared by the senders of the direction),
+// and the k-th frame belongs to the CE at position k % length of the stream, so the sending cycle only reads the stream:
+//   - shuffled: the stream consists of rounds, each of them is a different pseudorandom permutation of the CEs
+//   - random: each position is a uniformly distributed CE
+//   - Zipf: the CE of rank r (the r-th CE of the CE array) is chosen with a probability proportional to 1/r^skew,
+//     sampled by the rejection-inversion method of Hormann and Derflinger (no table of the N probabilities is needed)
+//   - hot set: the given percent of the frames belong to the given percent of the CEs (the first ones of the CE array),
+//     the rest of the frames to the other CEs (the CEs of both sets are chosen uniformly)
+// As the CE array is a pseudorandom enumeration of the EA-bits (see eaperm.h), the popular CEs are scattered over the MAP domain.
+// The streams are generated from CE-seed (a different one in each direction), so they are the same in each run with the same
+// non-zero seed.
+
+#define CE_ORDER_SEQUENTIAL 0
+#define CE_ORDER_SHUFFLED 1
+#define CE_ORDER_RANDOM 2
+#define CE_ORDER_ZIPF 3
+#define CE_ORDER_HOTSET 4
+
+#define CE_ORDER_LENGTH (1 << 24) // the minimum number of positions of a stream (it is repeated after them)
+
+class CEOrder
+{
+public:
+  CEOrder(int order, uint32_t num_of_CEs, double skew, double hot_ces, double hot_load, uint64_t seed, uint32_t stream,
+          int socket_id, const char *direction_);
+  ~CEOrder();
+
+  uint32_t *index; // the CE indices of the positions of the stream
+  uint32_t length; // the number of positions (a multiple of the number of CEs in the shuffled order)
+
+private:
+  const char *direction;
+};
+
+// returns the index of the CE of the k-th frame of a direction (order is NULL in the sequential order)
+inline uint32_t frameCE(const CEOrder *order, uint64_t k, uint32_t num_of_CEs)
+{
+  return order ? order->index[k % order->length] : (uint32_t)(k % num_of_CEs);
+}
+
+#endif
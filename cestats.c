@@ -0,0 +1,186 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "classifier.h"
+#include "ceorder.h"
+#include "eatable.h"
+#include "cestats.h"
+
+// builds the CE index table of a direction from its CE array (see buildCEArray()), and allocates the counters of its receivers
+// The table is allocated in the memory of the NUMA node of the first receiver, and the counters in that of their own receiver.
+CEStats::CEStats(bool forward_, CE_data *CE_array_, const CEOrder *order_, uint32_t num_of_CEs_, uint8_t bmr_ipv4_suffix_length, uint8_t psid_length_,
+                 struct in6_addr *bg_dst_, const int *receiver_cpus, int num_of_receivers_)
+{
+  const char *direction = forward_ ? "forward" : "reverse";
+
+  if (!CE_array_)
+    rte_exit(EXIT_FAILURE, "CEStats(): a NULL pointer to the array of CEs data in the %s direction!\n", direction);
+  forward = forward_;
+  CE_array = CE_array_;
+  order = order_;
+  num_of_CEs = num_of_CEs_;
+  suffix_mask = (uint32_t)((((uint64_t)1) << bmr_ipv4_suffix_length) - 1);
+  psid_mask = (((uint64_t)1) << psid_length_) - 1;
+  psid_length = psid_length_;
+  psid_shift = 16 - psid_length_;
+  rte_memcpy(bg_dst, bg_dst_, 16);
+  num_of_receivers = num_of_receivers_;
+  sent = NULL;
+  latency = NULL;
+
+  // the frames not belonging to any CE are counted in the extra slot
+  ce_index = new EATable(num_of_CEs, num_of_CEs, rte_lcore_to_socket_id(receiver_cpus[0]), "CE index table", direction);
+  for (uint32_t i = 0; i < num_of_CEs; i++)
+    ce_index->insert((uint64_t)(ntohl(CE_array[i].ipv4_addr) & suffix_mask) << psid_length | CE_array[i].psid, i);
+
+  for (int q = 0; q < num_of_receivers; q++)
+  {
+    counters[q] = (uint64_t *)rte_zmalloc_socket("per-CE counters", (num_of_CEs + 1) * sizeof(uint64_t), RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(receiver_cpus[q]));
+    if (!counters[q])
+      rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the per-CE counters of the %s receiver #%d!\n", direction, q);
+  }
+}
+
+CEStats::~CEStats()
+{
+  delete ce_index;
+  for (int q = 0; q < num_of_receivers; q++)
+    rte_free(counters[q]);
+  rte_free(sent);
+  rte_free(latency);
+}
+
+// calculates the number of foreground frames sent to (or from) each CE
+// The k-th frame of a direction belongs to the CE at position k % length of the CE order (see frameCE()), and it is a foreground frame, if k % n < m.
+// A sender replaying a ring of ring_size[q] pre-rendered frames (see send()) repeats the frames of the first ring_size[q] frames of its slice,
+// thus each of them is weighted by the number of its replays (ring_size is NULL, or ring_size[q] is 0, if there was no ring).
+void CEStats::countSent(uint64_t frames_to_send, int num_of_senders, const uint64_t *ring_size, uint32_t n, uint32_t m)
+{
+  sent = (uint64_t *)rte_zmalloc("per-CE sent frames", num_of_CEs * sizeof(uint64_t), 0);
+  if (!sent)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the per-CE sent frame counters!\n");
+  for (int q = 0; q < num_of_senders; q++)
+  {
+    uint64_t own_frames = (frames_to_send + num_of_senders - 1 - q) / num_of_senders; // see send()
+    uint64_t ring = ring_size ? ring_size[q] : 0;
+    uint64_t frames = ring ? ring : own_frames; // the number of different frames of the slice
+    uint32_t length = order ? order->length : num_of_CEs;
+    uint32_t pos = q % length;                   // k % length and k % n are calculated incrementally
+    uint32_t r = q % n;
+    for (uint64_t j = 0; j < frames; j++)
+    {
+      if (r < m)
+        sent[order ? order->index[pos] : pos] += ring ? own_frames / ring + (j < own_frames % ring) : 1;
+      if ((pos += num_of_senders) >= length)
+        pos %= length;
+      if ((r += num_of_senders) >= n)
+        r %= n;
+    }
+  }
+}
+
+// adds a tagged frame sent to (or from) the given CE to its latency statistics
+void CEStats::addLatency(uint32_t ce, bool received, double lat)
+{
+  if (!latency)
+  {
+    latency = (CELatency *)rte_zmalloc("per-CE latencies", num_of_CEs * sizeof(CELatency), 0);
+    if (!latency)
+      rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the per-CE latencies!\n");
+  }
+  latency[ce].tagged++;
+  if (received)
+  {
+    latency[ce].received++;
+    latency[ce].sum += lat;
+    if (lat > latency[ce].max)
+      latency[ce].max = lat;
+  }
+}
+
+// sums up the counters of the receivers, and reports the fairness of the direction, its worst-served CEs, and the per-CE CSV file
+void CEStats::report(const char *direction)
+{
+  uint64_t *received = counters[0]; // the counters of the receivers are summed up into the first one
+  double ratio_sum = 0, ratio_sq_sum = 0; // for Jain's fairness index of the delivery ratios
+  uint32_t num_served = 0;                // the number of CEs with sent frames
+  char filename[64], ipv4[INET_ADDRSTRLEN], ipv6[INET6_ADDRSTRLEN];
+  FILE *f;
+
+  for (int q = 1; q < num_of_receivers; q++)
+    for (uint32_t i = 0; i <= num_of_CEs; i++)
+      received[i] += counters[q][i];
+  if (received[num_of_CEs])
+    printf("Warning: %s frames not belonging to any CE: %lu\n", direction, received[num_of_CEs]);
+
+  // the delivery ratio of a CE is received/sent; the CEs without any sent frames are left out
+  double *ratio = new double[num_of_CEs];
+  uint32_t *order = new uint32_t[num_of_CEs]; // the CEs with sent frames, to be ordered by their delivery ratios
+  for (uint32_t i = 0; i < num_of_CEs; i++)
+  {
+    ratio[i] = sent[i] ? (double)received[i] / sent[i] : 0;
+    if (sent[i])
+    {
+      ratio_sum += ratio[i];
+      ratio_sq_sum += ratio[i] * ratio[i];
+      order[num_served++] = i;
+    }
+  }
+  printf("Info: %s per-CE statistics: CEs with sent frames: %u, Jain's fairness index: %.6lf\n", direction, num_served,
+         ratio_sq_sum ? ratio_sum * ratio_sum / (num_served * ratio_sq_sum) : 0.0);
+
+  uint32_t num_worst = num_served < CE_STATS_WORST ? num_served : CE_STATS_WORST;
+  std::partial_sort(order, order + num_worst, order + num_served, [ratio](uint32_t a, uint32_t b) { return ratio[a] < ratio[b] || (ratio[a] == ratio[b] && a < b); });
+  for (uint32_t k = 0; k < num_worst; k++)
+  {
+    uint32_t i = order[k];
+    inet_ntop(AF_INET, &CE_array[i].ipv4_addr, ipv4, sizeof(ipv4));
+    printf("Info: %s worst-served CE #%u: %s PSID %u: sent: %lu, received: %lu, delivery ratio: %.6lf\n",
+           direction, i, ipv4, CE_array[i].psid, sent[i], received[i], ratio[i]);
+  }
+
+  snprintf(filename, sizeof(filename), "%s-%s.csv", CE_STATS_FILE, direction);
+  if (!(f = fopen(filename, "w")))
+    std::cerr << "Error: could not create the per-CE statistics file '" << filename << "'." << std::endl;
+  else
+  {
+    fprintf(f, "CE,IPv4 address,PSID,MAP address,sent,received,delivery ratio");
+    if (latency)
+      fprintf(f, ",tagged sent,tagged received,average latency (ms),maximum latency (ms)");
+    fprintf(f, "\n");
+    for (uint32_t i = 0; i < num_of_CEs; i++)
+    {
+      inet_ntop(AF_INET, &CE_array[i].ipv4_addr, ipv4, sizeof(ipv4));
+      inet_ntop(AF_INET6, &CE_array[i].map_addr, ipv6, sizeof(ipv6));
+      fprintf(f, "%u,%s,%u,%s,%lu,%lu,%.6lf", i, ipv4, CE_array[i].psid, ipv6, sent[i], received[i], ratio[i]);
+      if (latency)
+        fprintf(f, ",%u,%u,%.6lf,%.6lf", latency[i].tagged, latency[i].received,
+                latency[i].received ? latency[i].sum / latency[i].received : 0.0, latency[i].max);
+      fprintf(f, "\n");
+    }
+    fclose(f);
+    printf("Info: %s per-CE statistics were written into '%s'\n", direction, filename);
+  }
+  delete[] ratio;
+  delete[] order;
+}
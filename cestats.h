@@ -0,0 +1,116 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CESTATS_H_INCLUDED
+#define CESTATS_H_INCLUDED
+
+// Per-CE accounting of the received Test Frames (optional, see 'CE-stats' in the configuration file)
+//
+// The receivers map each translated Test Frame back to the index of its CE in the CE array by a hash table (see eatable.h),
+// whose keys are the EA-bits combinations (IPv4 suffix << psid_length | PSID) of the CEs, thus its size depends on
+// NUM-OF-CEs only. The EA-bits combination of a frame is:
+//   forward: the suffix of the IPv4 source address and the port set of the source port
+//   reverse: the IPv4 address and the PSID in the Interface ID of the IPv6 destination address (background frames are skipped)
+// Frames not belonging to any simulated CE are counted in an extra slot after the CEs.
+// Each receiver counts into its own array, so the receivers of a direction do not disturb each other. A burst is processed
+// in three passes (EA-bits, table lookup, counting), and the table slots and the counters are prefetched between the passes,
+// so their cache misses overlap even with large CE arrays (the table and the counters do not fit into the cache).
+//
+// After the test, the number of foreground frames sent to (or from) each CE is calculated from the order of the CEs (see
+// countSent()), and the latencies of the tagged frames (Latency Frames or PDV Frames) are added to their CEs (see addLatency()).
+// The report contains Jain's fairness index of the per-CE delivery ratios, the CE_STATS_WORST worst-served CEs, and
+// a CSV file (CE_STATS_FILE-<direction>.csv) with one line per CE.
+
+#define CE_STATS_FILE "ce-stats" // prefix of the name of the CSV files
+#define CE_STATS_WORST 10        // the number of the worst-served CEs listed in the report
+
+// latency statistics of the tagged frames of a CE
+struct CELatency
+{
+  uint32_t tagged;   // number of tagged frames sent
+  uint32_t received; // number of tagged frames received
+  double sum;        // the sum of their latencies (in milliseconds)
+  double max;        // the maximum of their latencies (in milliseconds)
+};
+
+class CEStats
+{
+public:
+  CEStats(bool forward_, CE_data *CE_array_, const CEOrder *order_, uint32_t num_of_CEs_, uint8_t bmr_ipv4_suffix_length, uint8_t psid_length_,
+          struct in6_addr *bg_dst_, const int *receiver_cpus, int num_of_receivers_);
+  ~CEStats();
+
+  // counts the translated Test Frames of a burst, whose bit masks are given by classifyBurst() (see classifier.h), per CE
+  inline void count(struct rte_mbuf **pkt_mbufs, RxMasks test, uint16_t queue_id)
+  {
+    uint32_t frames = forward ? test.ipv4 : test.ipv6;
+    uint64_t *received = counters[queue_id];
+    uint64_t ea[MAX_PKT_BURST]; // EA-bits of the frames
+    uint32_t ce[MAX_PKT_BURST]; // CE indices of the frames
+    int num = 0, i;
+    for (; frames; frames &= frames - 1)
+    {
+      const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[__builtin_ctz(frames)], const uint8_t *);
+      if (forward)
+        // IPv4 source address: 14+12=26, source port: 14+20=34
+        ea[num] = (uint64_t)(rte_be_to_cpu_32(*(const uint32_t *)&pkt[26]) & suffix_mask) << psid_length | rte_be_to_cpu_16(*(const uint16_t *)&pkt[34]) >> psid_shift;
+      else
+      {
+        // IPv6 destination address: 14+24=38, its Interface ID: 38+8=46
+        if (*(const uint64_t *)&pkt[38] == bg_dst[0] && *(const uint64_t *)&pkt[46] == bg_dst[1])
+          continue;
+        uint64_t iid = rte_be_to_cpu_64(*(const uint64_t *)&pkt[46]);
+        ea[num] = (uint64_t)((iid >> 16) & suffix_mask) << psid_length | (iid & psid_mask);
+      }
+      ce_index->prefetch(ea[num]);
+      num++;
+    }
+    for (i = 0; i < num; i++)
+    {
+      ce[i] = ce_index->lookup(ea[i]);
+      rte_prefetch0(&received[ce[i]]);
+    }
+    for (i = 0; i < num; i++)
+      received[ce[i]]++;
+  }
+
+  void countSent(uint64_t frames_to_send, int num_of_senders, const uint64_t *ring_size, uint32_t n, uint32_t m);
+  void addLatency(uint32_t ce, bool received, double latency);
+  uint32_t frameCE(uint64_t k) { return ::frameCE(order, k, num_of_CEs); } // the CE of the k-th frame of the direction
+  void report(const char *direction);
+
+private:
+  bool forward;            // test direction (the received frames are IPv4 frames in the forward direction)
+  CE_data *CE_array;       // the CEs of the direction
+  const CEOrder *order;    // the order of the CEs visited by the frames (NULL in the sequential order, see ceorder.h)
+  uint32_t num_of_CEs;     // the number of CEs
+  uint32_t suffix_mask;    // the IPv4 suffix bits of the CE addresses
+  uint64_t psid_mask;      // the PSID bits
+  uint8_t psid_length;     // the number of PSID bits
+  uint8_t psid_shift;      // the PSID of a port number is port >> psid_shift
+  uint64_t bg_dst[2];      // the destination address of the background frames (as two 64-bit words)
+  EATable *ce_index;       // the index of the CE of an EA-bits combination (num_of_CEs, if it does not belong to any CE)
+  int num_of_receivers;    // the number of receivers of the direction
+  uint64_t *counters[MAX_RECEIVERS]; // the per-CE received frame counters of the receivers (num_of_CEs+1 elements each)
+  uint64_t *sent;          // the number of foreground frames sent to (or from) each CE (see countSent())
+  CELatency *latency;      // the latency statistics of the CEs (allocated by the first addLatency() call)
+};
+
+#endif
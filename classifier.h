@@ -0,0 +1,138 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLASSIFIER_H_INCLUDED
+#define CLASSIFIER_H_INCLUDED
+
+#ifdef __SSE4_1__
+#include <immintrin.h>
+#endif
+
+// Burst classifier of the received frames shared by receive(), receiveLatency() and receivePdv()
+//
+// Instead of inspecting the frames of a burst one by one with data dependent branches, the signature checks of the whole
+// burst are evaluated without branches into bit masks (bit i belongs to the i-th frame of the burst), thus the frames
+// can be counted by popcount, and only the special frames (e.g. Latency Frames) are to be visited individually.
+// Offsets from the start of the Ethernet Frame:
+//   IPv6 Test Frame: EtherType (12) is 0x86DD, Next Header (14+6=20) is UDP, UDP Data (14+40+8=62) starts with the identifier
+//   IPv4 Test Frame: EtherType (12) is 0x0800, Protocol (14+9=23) is UDP, UDP Data (14+20+8=42) starts with the identifier
+// The header fields are checked by a single masked 16-byte SSE4.1 comparison of bytes 12-27 of a frame (if the CPU
+// supports it), and the identifiers are compared as 64-bit words. The data of the frames is prefetched RX_PREFETCH frames ahead.
+// Remark: the UDP data of short frames is read beyond their end, but still inside their mbuf (its data room is much larger).
+
+#if MAX_PKT_BURST > 32
+#error "The bit masks of the burst classifier can not hold more than 32 frames"
+#endif
+
+#define RX_PREFETCH 4 // the data of the received frames is prefetched so many frames ahead
+
+// bit masks of the frames of a burst carrying an identifier
+struct RxMasks
+{
+  uint32_t ipv6; // IPv6 frames
+  uint32_t ipv4; // IPv4 frames
+};
+
+// classifies a burst of received frames: masks[k] is set to the bit masks of the IPv6 and IPv4 UDP frames carrying the identifier ids[k]
+template <int NumIds>
+inline void classifyBurst(struct rte_mbuf **pkt_mbufs, int frames, const uint64_t *ids, RxMasks *masks)
+{
+#ifdef __SSE4_1__
+  // bytes 12-27 of the frame: the EtherType is at 0-1, the IPv6 Next Header is at 8, the IPv4 Protocol is at 11
+  const __m128i sel6 = _mm_setr_epi8(-1, -1, 0, 0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i pat6 = _mm_setr_epi8((char)0x86, (char)0xDD, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i sel4 = _mm_setr_epi8(-1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1, 0, 0, 0, 0);
+  const __m128i pat4 = _mm_setr_epi8(0x08, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 17, 0, 0, 0, 0);
+#else
+  const uint16_t ipv4 = htons(0x0800); // EtherType for IPv4 in Network Byte Order
+  const uint16_t ipv6 = htons(0x86DD); // EtherType for IPv6 in Network Byte Order
+#endif
+  int i;
+  for (int k = 0; k < NumIds; k++)
+    masks[k].ipv6 = masks[k].ipv4 = 0;
+  for (i = 0; i < RX_PREFETCH && i < frames; i++)
+    rte_prefetch0(rte_pktmbuf_mtod(pkt_mbufs[i], void *));
+  for (i = 0; i < frames; i++)
+  {
+    if (i + RX_PREFETCH < frames)
+      rte_prefetch0(rte_pktmbuf_mtod(pkt_mbufs[i + RX_PREFETCH], void *));
+    const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], const uint8_t *);
+#ifdef __SSE4_1__
+    __m128i hdr = _mm_loadu_si128((const __m128i *)(pkt + 12));
+    uint32_t udp6 = _mm_testz_si128(_mm_xor_si128(hdr, pat6), sel6); // 1: all the selected bytes are equal to the pattern
+    uint32_t udp4 = _mm_testz_si128(_mm_xor_si128(hdr, pat4), sel4);
+#else
+    uint32_t udp6 = (*(const uint16_t *)&pkt[12] == ipv6) & (pkt[20] == 17);
+    uint32_t udp4 = (*(const uint16_t *)&pkt[12] == ipv4) & (pkt[23] == 17);
+#endif
+    uint64_t data6 = *(const uint64_t *)&pkt[62];
+    uint64_t data4 = *(const uint64_t *)&pkt[42];
+    for (int k = 0; k < NumIds; k++)
+    {
+      masks[k].ipv6 |= (udp6 & (data6 == ids[k])) << i;
+      masks[k].ipv4 |= (udp4 & (data4 == ids[k])) << i;
+    }
+  }
+}
+
+// clears the bits of the Test Frames of a burst whose trial ID differs from the given one, and returns their number
+// (they are late frames of an earlier trial of a binary search, see search.h)
+// Offsets of the trial ID from the start of the Ethernet Frame: IPv6: 14+40+8+16=78, IPv4: 14+20+8+16=58
+inline int filterTrial(struct rte_mbuf **pkt_mbufs, RxMasks *test, uint16_t trial)
+{
+  uint32_t stale = 0;
+  uint32_t frames = test->ipv6 | test->ipv4;
+  for (; frames; frames &= frames - 1)
+  {
+    int i = __builtin_ctz(frames);
+    const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], const uint8_t *);
+    if (*(const uint16_t *)&pkt[test->ipv6 & (1u << i) ? 78 : 58] != trial)
+      stale |= 1u << i;
+  }
+  test->ipv6 &= ~stale;
+  test->ipv4 &= ~stale;
+  return __builtin_popcount(stale);
+}
+
+// frees a burst of received frames: the mbufs released by rte_pktmbuf_prefree_seg() are put back into their pool together
+// (all the frames of a burst come from the packet pool of the RX queue; other frames are freed individually)
+inline void freeBurst(struct rte_mbuf **pkt_mbufs, int frames)
+{
+  struct rte_mbuf *released[MAX_PKT_BURST]; // the mbufs to be put back into the pool
+  int num_released = 0;
+  if (!frames)
+    return;
+  struct rte_mempool *pool = pkt_mbufs[0]->pool;
+  for (int i = 0; i < frames; i++)
+  {
+    struct rte_mbuf *m = pkt_mbufs[i];
+    if (likely(m->nb_segs == 1 && m->pool == pool))
+    {
+      if ((m = rte_pktmbuf_prefree_seg(m)) != NULL)
+        released[num_released++] = m;
+    }
+    else
+      rte_pktmbuf_free(m);
+  }
+  if (num_released)
+    rte_mempool_put_bulk(pool, (void **)released, num_released);
+}
+
+#endif
@@ -24,8 +24,14 @@
 #define RIGHTPORT 1                /* port ID of the "Right" port */
 #define MAX_PORT_TRIALS 10         /* rte_eth_link_get() is attempted maximum so many times, and error is reported if still unsuccessful */
 #define START_DELAY 5000           /* Delay (ms) before senders start sending, used for synchronized start. Beware that DUT NICs need time to get ready! */
+#define TRIAL_START_DELAY 500      /* Delay (ms) before senders start sending in the further trials of a binary search, see search.h */
 #define TOLERANCE 1.00001          /* Maximum allowed time inaccuracy, 1.00001 allows 0.001% more time for sending */
-#define N 40                       /* used for PDV and varport: all frames exist in N copies to mitigate the problem of write after send */
+#define MAX_SENDERS 16             /* maximum number of sender lcores (and TX queues) per direction */
+#define MAX_RECEIVERS 16           /* maximum number of receiver lcores (and RX queues) per direction */
+#define REUSE_TIMEOUT 100          /* Maximum time (ms) to wait for the NIC to release a template frame before it is updated again, see generator.h */
+#define SPLIT_DATA 16              /* in frame split mode, the header segment of a frame contains the first SPLIT_DATA bytes of its UDP data */
+#define MAX_NUM_OF_CES 100000000  /* maximum value of NUM-OF-CEs (each CE takes 52 bytes of hugepage memory per direction, see reserveCETable()) */
+#define CE_PREFETCH 8              /* the hot record of a CE is prefetched so many frames before its use by a sender, see generator.h */
 
 //#define WIDE_DPORT_MIN 1     // default value: use maximum range recommended by RFC 4814
 //#define WIDE_DPORT_MAX 49151 // default value: use maximum range recommended by RFC 4814
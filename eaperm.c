@@ -0,0 +1,54 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "eaperm.h"
+
+// the 64-bit SplitMix generator is used for deriving the round keys from the seed
+static uint64_t splitMix64(uint64_t &x)
+{
+  uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+EAPermutation::EAPermutation(uint8_t ip4_suffix_length, uint8_t psid_length_, uint64_t seed, uint32_t stream)
+{
+  int bits = 0; // the number of bits covering [0, size)
+  psid_length = psid_length_;
+  size = ((((uint64_t)1) << ip4_suffix_length) - 2) << psid_length; // -2 to exclude the subnet and broadcast addresses
+  while (bits < 64 && (((uint64_t)1) << bits) < size)
+    bits++;
+  half_bits = (bits + 1) / 2;
+  half_mask = (((uint64_t)1) << half_bits) - 1;
+
+  if (!seed)
+  {
+    std::random_device rd; // Will be used to obtain a seed
+    seed = ((uint64_t)rd() << 32) | rd();
+  }
+  uint64_t x = seed ^ (0xd1b54a32d192ed03 * (stream + 1)); // the streams of the same seed are different
+  for (int r = 0; r < EA_PERM_ROUNDS; r++)
+    keys[r] = splitMix64(x);
+}
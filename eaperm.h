@@ -0,0 +1,82 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EAPERM_H_INCLUDED
+#define EAPERM_H_INCLUDED
+
+// Pseudorandom enumeration of the EA-bits combinations of the simulated CEs (see buildCEArray())
+//
+// The simulated CEs are the first NUM-OF-CEs elements of a pseudorandom permutation of all the (2^suffix-2)*2^psid
+// EA-bits combinations (the all-zeros and all-ones IPv4 suffixes are excluded). Instead of shuffling an array of all
+// of them (8 bytes per combination, e.g. 32GB with 16 suffix and 16 PSID bits), any element of the permutation is
+// computed on demand, thus the CE array is built in O(NUM-OF-CEs) time and memory, and EA-bits up to 48 bits can be used:
+//   - the index i of the combination (suffix, psid) is (suffix-1)*2^psid + psid, i is in [0, size)
+//   - a balanced Feistel network of EA_PERM_ROUNDS keyed rounds is a bijection of [0, 2^(2*h)), where 2*h is the smallest
+//     even number of bits covering [0, size), and the values outside [0, size) are skipped by cycle walking (the network
+//     is applied again to them), which keeps it a bijection of [0, size); as 2^(2*h) < 4*size, it takes less than 4
+//     applications on average
+// The round keys are derived from the seed and the stream by SplitMix64, so the same seed gives the same permutation
+// (a different one for each stream). If the seed is 0, a random seed is taken from std::random_device.
+
+#define EA_PERM_ROUNDS 6 // the number of the rounds of the Feistel network
+
+class EAPermutation
+{
+public:
+  EAPermutation(uint8_t ip4_suffix_length, uint8_t psid_length_, uint64_t seed, uint32_t stream);
+  inline EAbits48 get(uint64_t index); // returns the combination at the given position of the permutation (index < size)
+  uint64_t size;                       // the number of the EA-bits combinations
+
+private:
+  inline uint64_t feistel(uint64_t x);
+  uint8_t psid_length;
+  int half_bits;                  // the number of bits of the halves of the Feistel network
+  uint64_t half_mask;
+  uint64_t keys[EA_PERM_ROUNDS];  // the round keys
+};
+
+inline uint64_t EAPermutation::feistel(uint64_t x)
+{
+  uint64_t left = x >> half_bits, right = x & half_mask;
+  for (int r = 0; r < EA_PERM_ROUNDS; r++)
+  {
+    uint64_t z = (right ^ keys[r]) * 0xbf58476d1ce4e5b9; // the round function: the finalizer of SplitMix64
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    uint64_t next = left ^ ((z ^ (z >> 31)) & half_mask);
+    left = right;
+    right = next;
+  }
+  return left << half_bits | right;
+}
+
+inline EAbits48 EAPermutation::get(uint64_t index)
+{
+  EAbits48 ea;
+  uint64_t x = index;
+  do
+    x = feistel(x); // cycle walking: both index and the result are in [0, size)
+  while (x >= size);
+  ea.ip4_suffix = (uint32_t)(x >> psid_length) + 1;
+  ea.psid = (uint16_t)(x & ((((uint64_t)1) << psid_length) - 1));
+  return ea;
+}
+
+#endif
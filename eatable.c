@@ -0,0 +1,57 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "eatable.h"
+
+// allocates an empty table for num_of_keys keys in the memory of the given NUMA node
+EATable::EATable(uint64_t num_of_keys, uint32_t not_found_, int socket_id, const char *name, const char *direction)
+{
+  uint64_t num_of_slots = 2;
+  shift = 63;
+  while (num_of_slots < EA_TABLE_LOAD * num_of_keys)
+  {
+    num_of_slots <<= 1;
+    shift--;
+  }
+  mask = num_of_slots - 1;
+  not_found = not_found_;
+  slots = (Slot *)rte_malloc_socket(name, num_of_slots * sizeof(Slot), RTE_CACHE_LINE_SIZE, socket_id);
+  if (!slots)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the %s in the %s direction!\n", name, direction);
+  for (uint64_t s = 0; s < num_of_slots; s++)
+    slots[s].key = EA_TABLE_EMPTY;
+}
+
+EATable::~EATable()
+{
+  rte_free(slots);
+}
+
+void EATable::insert(uint64_t key, uint32_t value)
+{
+  uint64_t s = slot(key);
+  for (; slots[s].key != EA_TABLE_EMPTY; s = (s + 1) & mask)
+    if (slots[s].key == key)
+      return;
+  slots[s].key = key;
+  slots[s].value = value;
+}
@@ -0,0 +1,71 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef EATABLE_H_INCLUDED
+#define EATABLE_H_INCLUDED
+
+// Hash table of the EA-bits combinations (or the IPv4 suffixes) of the simulated CEs, used by the receivers
+// (see validator.h and cestats.h)
+//
+// Its size depends on the number of keys (and not on the 2^EA possible keys), so the full 48-bit EA range can be used:
+// it is an open addressing table of at least EA_TABLE_LOAD*num_of_keys slots (a power of 2) with linear probing.
+// A slot takes 16 bytes (4 of them in a cache line), the keys are spread over the slots by Fibonacci hashing, and a lookup
+// usually touches a single cache line, which can be prefetched by the receivers before the lookups of a burst.
+
+#define EA_TABLE_LOAD 2         // the minimum number of slots per key
+#define EA_TABLE_EMPTY (~0ULL)  // the key of the empty slots (a valid key has at most 48 bits)
+
+class EATable
+{
+public:
+  EATable(uint64_t num_of_keys, uint32_t not_found_, int socket_id, const char *name, const char *direction);
+  ~EATable();
+
+  void insert(uint64_t key, uint32_t value); // a key already in the table keeps its first value
+
+  // returns the value of a key (not_found, if it is not in the table)
+  inline uint32_t lookup(uint64_t key) const
+  {
+    for (uint64_t s = slot(key);; s = (s + 1) & mask)
+    {
+      if (slots[s].key == key)
+        return slots[s].value;
+      if (slots[s].key == EA_TABLE_EMPTY)
+        return not_found;
+    }
+  }
+  inline bool contains(uint64_t key) const { return lookup(key) != not_found; }
+  inline void prefetch(uint64_t key) const { rte_prefetch0(&slots[slot(key)]); }
+
+private:
+  inline uint64_t slot(uint64_t key) const { return key * 0x9e3779b97f4a7c15ULL >> shift; }
+
+  struct Slot
+  {
+    uint64_t key;
+    uint32_t value;
+  };
+  Slot *slots;        // the slots of the table
+  uint64_t mask;      // the number of slots - 1
+  int shift;          // 64 - log2(the number of slots)
+  uint32_t not_found; // the value returned for the keys not in the table
+};
+
+#endif
@@ -0,0 +1,254 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "randport.h"
+#include "pacer.h"
+#include "ceorder.h"
+#include "generator.h"
+
+// sets the pointers to the varying fields of an IPv4 or IPv6 frame, and saves its checksums
+// Offsets from the start of the Ethernet Frame:
+// IPv4 header checksum: 14+10=24, IPv4 destination address: 14+16=30, UDP header for IPv4: 14+20=34, UDP Data for IPv4: 14+20+8=42
+// IPv6 source address: 14+8=22, UDP header for IPv6: 14+40=54, UDP Data for IPv6: 14+40+8=62
+FrameFields frameFields(struct rte_mbuf *pkt_mbuf, bool ipv4, bool chksum_offload)
+{
+  FrameFields f;
+  uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbuf, uint8_t *); // Access the Test Frame in the message buffer
+  int udp = ipv4 ? 34 : 54;                             // offset of the UDP header
+
+  if (chksum_offload)
+  {
+    // the NIC calculates the checksums: it needs the header lengths and the pseudo header checksum in the UDP checksum field
+    pkt_mbuf->l2_len = sizeof(struct ether_hdr);
+    if (ipv4)
+    {
+      struct ipv4_hdr *ip = (struct ipv4_hdr *)(pkt + sizeof(struct ether_hdr));
+      pkt_mbuf->l3_len = sizeof(struct ipv4_hdr);
+      pkt_mbuf->ol_flags |= PKT_TX_IPV4 | PKT_TX_IP_CKSUM | PKT_TX_UDP_CKSUM;
+      ip->hdr_checksum = 0;
+      *(uint16_t *)(pkt + udp + 6) = rte_ipv4_phdr_cksum(ip, pkt_mbuf->ol_flags);
+    }
+    else
+    {
+      struct ipv6_hdr *ip = (struct ipv6_hdr *)(pkt + sizeof(struct ether_hdr));
+      pkt_mbuf->l3_len = sizeof(struct ipv6_hdr);
+      pkt_mbuf->ol_flags |= PKT_TX_IPV6 | PKT_TX_UDP_CKSUM;
+      *(uint16_t *)(pkt + udp + 6) = rte_ipv6_phdr_cksum(ip, pkt_mbuf->ol_flags);
+    }
+  }
+
+  f.pkt_mbuf = pkt_mbuf;
+  f.src_ipv6 = ipv4 ? NULL : (struct in6_addr *)(pkt + 22);
+  f.dst_ipv4 = ipv4 ? (uint32_t *)(pkt + 30) : NULL;
+  f.ipv4_chksum = ipv4 ? (uint16_t *)(pkt + 24) : NULL;
+  f.udp_sport = (uint16_t *)(pkt + udp);
+  f.udp_dport = (uint16_t *)(pkt + udp + 2);
+  f.udp_chksum = (uint16_t *)(pkt + udp + 6);
+  f.counter = (uint64_t *)(pkt + udp + 16);
+  f.udp_chksum_start = chksum_offload ? *f.udp_chksum : ~*f.udp_chksum; // the pseudo header checksum is not complemented
+  f.ipv4_chksum_start = ipv4 && !chksum_offload ? ~*f.ipv4_chksum : 0;
+  return f;
+}
+
+// moves the payload of a frame beyond its first hdr_len bytes into the shared payload segment (*payload, created by the first call),
+// and chains an indirect segment pointing to it to the frame
+// The payload of all the frames using the same shared payload segment must be the same.
+void splitFrame(struct rte_mbuf *pkt_mbuf, uint16_t hdr_len, struct rte_mbuf **payload, rte_mempool *pkt_pool, const char *direction)
+{
+  uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbuf, uint8_t *);
+  uint16_t payload_len = pkt_mbuf->data_len - hdr_len;
+  struct rte_mbuf *seg; // the indirect segment of the frame
+
+  if (!*payload)
+  {
+    *payload = rte_pktmbuf_alloc(pkt_pool);
+    if (!*payload)
+      rte_exit(EXIT_FAILURE, "Error: %s sender can't allocate a new mbuf for the shared payload! \n", direction);
+    (*payload)->pkt_len = (*payload)->data_len = payload_len;
+    rte_memcpy(rte_pktmbuf_mtod(*payload, uint8_t *), pkt + hdr_len, payload_len);
+  }
+  else if ((*payload)->data_len != payload_len || memcmp(rte_pktmbuf_mtod(*payload, uint8_t *), pkt + hdr_len, payload_len))
+    rte_exit(EXIT_FAILURE, "Error: the payload of a frame of the %s sender differs from the shared payload! \n", direction);
+
+  seg = rte_pktmbuf_alloc(pkt_pool);
+  if (!seg)
+    rte_exit(EXIT_FAILURE, "Error: %s sender can't allocate a new mbuf for the payload segment! \n", direction);
+  rte_pktmbuf_attach(seg, *payload); // it points to the data of the shared payload
+  pkt_mbuf->data_len = hdr_len;      // pkt_len remains the length of the whole frame
+  pkt_mbuf->next = seg;
+  pkt_mbuf->nb_segs = 2;
+}
+
+TxBurst::TxBurst(uint8_t eth_id_, uint16_t queue_id_, uint16_t stride_, uint16_t burst_limit_, senderCommonParameters *cp, uint64_t frames_to_send_,
+                 struct txCounters *counters_)
+    : pacer(cp, queue_id_, stride_)
+{
+  eth_id = eth_id_;
+  queue_id = queue_id_;
+  stride = stride_;
+  burst_limit = burst_limit_;
+  frames_to_send = frames_to_send_;
+  tx_pending = 0;
+  burst_first = 0;
+  burst_due = 0;
+  counters = counters_;
+}
+
+FrameGenerator::FrameGenerator(senderParameters *p_)
+{
+  senderCommonParameters *cp = p_->cp;
+  unsigned var_ps; // how the port restricted to the port set varies
+
+  p = p_;
+  forward = !strcmp(p->direction, "forward");
+  chksum_offload = p->chksum_offload;
+  frame_split = p->frame_split;
+  var_sport = p->var_sport;
+  var_dport = p->var_dport;
+  n = cp->n;
+  m = cp->m;
+  mix = m == 0 ? MIX_BG : (m >= n ? MIX_FG : MIX_BOTH);
+  CE6 = forward ? (const CEHot6 *)p->hot_CEs : NULL;
+  CE4 = forward ? NULL : (const CEHot4 *)p->hot_CEs;
+  num_of_CEs = cp->num_of_CEs;
+  CE_stream = p->ce_order ? p->ce_order->index : NULL;
+  stream_length = p->ce_order ? p->ce_order->length : num_of_CEs;
+  num_of_ports = cp->num_of_ports;
+
+  // check whether the CE array is built or not
+  if (!p->hot_CEs)
+    rte_exit(EXIT_FAILURE, "No CE array can be accessed by the %s sender", p->direction);
+
+  // the IPv4 address of the right interface of the Tester is copied, as the parameters are shared by the senders
+  src_ipv4 = *cp->tester_r_ipv4;
+  zero_dst_ipv4 = 0;
+  memset(&zero_src_ipv6, 0, sizeof(zero_src_ipv6));
+  dst_ipv6 = cp->dmr_ipv6;
+  src_bg = forward ? cp->tester_l_ipv6 : cp->tester_r_ipv6;
+  dst_bg = forward ? cp->tester_r_ipv6 : cp->tester_l_ipv6;
+
+  // the port not restricted to a port set is varied in the wide range prespecified in the configuration file (usually comply with RFC 4814)
+  port_min = p->preconfigured_port_min;
+  port_max = p->preconfigured_port_max;
+  port = (forward ? var_dport : var_sport) == 2 ? port_max : port_min;
+  bg_sport_min = cp->bg_sport_min;
+  bg_sport_max = cp->bg_sport_max;
+  bg_dport_min = cp->bg_dport_min;
+  bg_dport_max = cp->bg_dport_max;
+  bg_sport = var_sport == 2 ? bg_sport_max : bg_sport_min;
+  bg_dport = var_dport == 2 ? bg_dport_max : bg_dport_min;
+
+  // the other port is varied in the range of the port set of the pseudorandomly enumerated CE, starting from its last value in that port set
+  var_ps = forward ? var_sport : var_dport;
+  curr_port_for_ps = new uint16_t[cp->num_of_port_sets];
+  for (uint32_t ps = 0; ps < cp->num_of_port_sets; ps++)
+    curr_port_for_ps[ps] = (uint16_t)(var_ps == 2 ? (ps + 1) * num_of_ports - 1 : ps * num_of_ports);
+
+  // the sender generates an interleaved slice of the frames (and of the CEs)
+  first_frame = p->queue_id;
+  stride = p->num_of_queues;
+
+  num_of_templates = p->num_of_templates;
+  fg_frames = new FrameFields[num_of_templates];
+  bg_frames = new FrameFields[num_of_templates];
+  for (int j = 0; j < num_of_templates; j++)
+    fg_frames[j].pkt_mbuf = bg_frames[j].pkt_mbuf = NULL;
+  payload = NULL;
+
+  i = 0;
+  current_CE = first_frame % stream_length;
+  prefetch_CE = (first_frame + (uint64_t)CE_PREFETCH * stride) % stream_length;
+}
+
+// the template frames are given back to the packet pool of the sender (the NIC may still own them, then it frees them
+// after their transmission), thus the pool can be reused by the next trial of a binary search (see search.h)
+FrameGenerator::~FrameGenerator()
+{
+  for (int j = 0; j < num_of_templates; j++)
+  {
+    if (fg_frames[j].pkt_mbuf)
+      rte_pktmbuf_free(fg_frames[j].pkt_mbuf);
+    if (bg_frames[j].pkt_mbuf)
+      rte_pktmbuf_free(bg_frames[j].pkt_mbuf);
+  }
+  if (payload)
+    rte_pktmbuf_free(payload);
+  delete[] curr_port_for_ps;
+  delete[] fg_frames;
+  delete[] bg_frames;
+}
+
+// sets the fields of a new frame of the sender (see frameFields()), and splits it in frame split mode, using the given shared payload
+// The header segment contains the headers and the first SPLIT_DATA bytes of the UDP data.
+// In a binary search, the trial ID is written into the frame first (see search.h), and its UDP checksum is updated incrementally
+// (in checksum offload mode, frameFields() replaces the UDP checksum with the pseudo header checksum anyway).
+FrameFields FrameGenerator::prepareFrame(struct rte_mbuf *pkt_mbuf, bool ipv4, struct rte_mbuf **shared_payload)
+{
+  uint16_t trial = p->cp->trial;
+  if (trial)
+  {
+    uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbuf, uint8_t *);
+    uint16_t *trial_id = (uint16_t *)(pkt + (ipv4 ? 58 : 78)); // UDP Data + 16 (after the identifier and the sequence number)
+    uint16_t *udp_chksum = (uint16_t *)(pkt + (ipv4 ? 34 : 54) + 6);
+    *udp_chksum = finishChksum((uint16_t)~*udp_chksum + (uint16_t)~*trial_id + trial);
+    *trial_id = trial;
+  }
+  FrameFields f = frameFields(pkt_mbuf, ipv4, chksum_offload);
+  if (frame_split)
+    splitFrame(pkt_mbuf, sizeof(struct ether_hdr) + (ipv4 ? sizeof(struct ipv4_hdr) : sizeof(struct ipv6_hdr)) + sizeof(struct udp_hdr) + SPLIT_DATA,
+               shared_payload, p->pkt_pool, p->direction);
+  return f;
+}
+
+// waits until the NIC releases a template frame (it is called only if the NIC still owns an earlier copy of the frame)
+// The driver is asked to release the already transmitted frames, but not all drivers support it, and then only the
+// transmission of further frames could release it: it is an error, as it means that there are too few template frames.
+void FrameGenerator::waitRelease(struct rte_mbuf *pkt_mbuf)
+{
+  uint64_t deadline = rte_rdtsc() + REUSE_TIMEOUT * rte_get_tsc_hz() / 1000;
+  while (rte_mbuf_refcnt_read(pkt_mbuf) > 1)
+  {
+    rte_eth_tx_done_cleanup(p->eth_id, p->queue_id, 0); // 0: as many frames as possible
+    if (rte_rdtsc() > deadline)
+      rte_exit(EXIT_FAILURE, "Error: the NIC did not release a template frame of the %s sender #%u in %u ms!\n", p->direction, p->queue_id, REUSE_TIMEOUT);
+  }
+}
+
+// creates the foreground and background template frames
+// (their payload is the same, as the length of the UDP data of the IPv4 and IPv6 frames is the same)
+void FrameGenerator::mkTemplates(mkFrame4Fn mkFrame4, mkFrame6Fn mkFrame6, mkFrame6Fn mkBgFrame6)
+{
+  senderCommonParameters *cp = p->cp;
+  if (!mkBgFrame6)
+    mkBgFrame6 = mkFrame6;
+  for (int j = 0; j < num_of_templates; j++)
+  {
+    // the foreground frame is an IPv4 frame in the reverse direction, and an IPv6 frame in the forward direction
+    if (forward)
+      fg_frames[j] = prepareFrame(mkFrame6(cp->ipv6_frame_size, p->pkt_pool, p->direction, p->dst_mac, p->src_mac, &zero_src_ipv6, dst_ipv6, var_sport, var_dport), false, &payload);
+    else
+      fg_frames[j] = prepareFrame(mkFrame4(cp->ipv4_frame_size, p->pkt_pool, p->direction, p->dst_mac, p->src_mac, &src_ipv4, &zero_dst_ipv4, var_sport, var_dport), true, &payload);
+    // the background frame is always an IPv6 frame between the interfaces of the Tester
+    bg_frames[j] = prepareFrame(mkBgFrame6(cp->ipv6_frame_size, p->pkt_pool, p->direction, p->dst_mac, p->src_mac, src_bg, dst_bg, var_sport, var_dport), false, &payload);
+  }
+}
@@ -0,0 +1,460 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATOR_H_INCLUDED
+#define GENERATOR_H_INCLUDED
+
+// Test Frame generator shared by send(), sendLatency() and sendPdv()
+//
+// Implementation of varying port numbers recommended by RFC 4814 https://tools.ietf.org/html/rfc4814#section-4.5
+// RFC 4814 requires pseudorandom port numbers, increasing and decreasing ones are our additional, non-stantard solutions.
+// Always one of the same pre-prepared foreground or background template frames is updated and sent: source and/or
+// destination IP addresses and port number(s), and UDP and IPv4 header checksums are updated.
+//
+// Write after send problem: a template frame must not be updated while the NIC still owns an earlier copy of it.
+// The segments of every frame are held (their reference counts are increased, see holdFrame()) before its transmission,
+// and the NIC driver decreases them, when it releases the frame, thus the NIC owns a template frame, if its reference
+// count is more than 1. The number of the template frames of each kind is calculated from the size of the TX ring
+// and the burst size so that their cyclic reuse guarantees this condition (see templateCount()). It is also checked
+// before each update, and if the frame is still owned by the NIC, the sender waits until the driver releases it.
+//
+// The sending cycle is a template, which is instantiated for every combination of the direction, the checksum offload mode,
+// the port number variation modes, the foreground/background mix and the measurement type. The combination is selected
+// only once before sending, thus the sending cycle contains no branches on the configuration.
+//
+// In checksum offload mode, the NIC calculates the IPv4 header checksum and the UDP checksum. The UDP checksum field of
+// the frames contains the checksum of the pseudo header only, thus only the addresses of the CEs are to be added to it
+// (using the checksums of the CE_data), the port numbers and the measurement specific fields are not.
+//
+// In frame split mode, a frame is a chain of two segments: a header segment containing the headers and the first SPLIT_DATA
+// bytes of the UDP data (the identifier and the measurement specific fields), and an indirect segment pointing to the
+// rest of the payload, which is stored only once and shared by all the frames of the sender. As the segments are held,
+// the NIC driver never breaks up the chains.
+//
+// If a direction has several senders, each of them runs its own generator on an interleaved slice of the frames:
+// sender k (using TX queue k) generates the frames k, k+S, k+2*S, ... (S is the number of senders), using the CEs
+// of the same positions of the shared CE order (see ceorder.h). The ordinal numbers of the frames (sent_frames) are always global,
+// thus the foreground/background mix, the sending times and the serial numbers are the same as with a single sender.
+//
+// The senders read the packed hot records of the CEs of their direction (see CEHot6 and CEHot4 in throughput.h), and
+// the record of the CE to be used CE_PREFETCH frames later is prefetched, thus with a CE array larger than the cache,
+// the address of a CE is usually in the cache by the time it is needed.
+//
+// A measurement type is a policy class with the following inline member functions:
+//   FrameFields *tagged(uint64_t sent_frames, bool fg)
+//     returns a special frame (e.g. a Latency Frame) to be sent instead of the next template frame, or NULL
+//   void patch(FrameFields *f, uint64_t sent_frames, uint32_t &chksum)
+//     sets the measurement specific fields of the frame (e.g. a serial number) and adds them to the UDP checksum
+//     (in checksum offload mode, chksum is a dummy variable)
+//   void send(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames, bool tagged)
+//     sends the frame (usually by TxBurst) and records the measurement specific data (e.g. timestamps)
+
+// foreground/background mix of the frames, determined by n and m
+#define MIX_BOTH 0 // foreground and background frames are mixed (0 < m < n)
+#define MIX_FG 1   // foreground frames only (m >= n)
+#define MIX_BG 2   // background frames only (m == 0)
+
+// pointers to the varying fields of a template frame, and the starting values of its checksums
+struct FrameFields
+{
+  struct rte_mbuf *pkt_mbuf;                    // the message buffer of the frame
+  struct in6_addr *src_ipv6;                    // source IPv6 address (the MAP address of the CE in forward foreground frames)
+  uint32_t *dst_ipv4;                           // destination IPv4 address (the IPv4 address of the CE in reverse foreground frames)
+  uint16_t *ipv4_chksum;                        // IPv4 header checksum (IPv4 frames only)
+  uint16_t *udp_sport, *udp_dport, *udp_chksum; // UDP header fields
+  uint64_t *counter;                            // 8 bytes after the identifier in the UDP data (serial number of the PDV Frames)
+  uint16_t udp_chksum_start;                    // uncomplemented UDP checksum taken from the original frame (pseudo header checksum in offload mode)
+  uint16_t ipv4_chksum_start;                   // uncomplemented IPv4 header checksum taken from the original frame (IPv4 frames only)
+};
+
+// sets the pointers to the varying fields of an IPv4 or IPv6 frame, and saves its checksums
+// In checksum offload mode, the frame is prepared for the calculation of its checksums by the NIC.
+FrameFields frameFields(struct rte_mbuf *pkt_mbuf, bool ipv4, bool chksum_offload);
+
+// moves the payload of a frame beyond its first hdr_len bytes into the shared payload segment (*payload, created by the first call),
+// and chains an indirect segment pointing to it to the frame
+void splitFrame(struct rte_mbuf *pkt_mbuf, uint16_t hdr_len, struct rte_mbuf **payload, rte_mempool *pkt_pool, const char *direction);
+
+// increases the reference count of all the segments of a frame, thus the NIC driver does not free them after transmission
+// (it only decreases the reference counts back, when it releases the frame)
+inline void holdFrame(struct rte_mbuf *pkt_mbuf)
+{
+  for (; pkt_mbuf; pkt_mbuf = pkt_mbuf->next)
+    rte_mbuf_refcnt_update(pkt_mbuf, 1);
+}
+
+// functions creating IPv4 and IPv6 template frames (e.g. mkTestFrame4() and mkTestFrame6())
+typedef struct rte_mbuf *(*mkFrame4Fn)(uint16_t length, rte_mempool *pkt_pool, const char *direction,
+                                       const struct ether_addr *dst_mac, const struct ether_addr *src_mac,
+                                       const uint32_t *src_ip, uint32_t *dst_ip, unsigned var_sport, unsigned var_dport);
+typedef struct rte_mbuf *(*mkFrame6Fn)(uint16_t length, rte_mempool *pkt_pool, const char *direction,
+                                       const struct ether_addr *dst_mac, const struct ether_addr *src_mac,
+                                       struct in6_addr *src_ip, struct in6_addr *dst_ip, unsigned var_sport, unsigned var_dport);
+
+// finalizes a 16-bit one's complement checksum
+inline uint16_t finishChksum(uint32_t chksum)
+{
+  chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // calculate 16-bit one's complement sum
+  chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // Twice is enough
+  chksum = (~chksum) & 0xffff;                                // make one's complement
+  if (chksum == 0)                                            // checksum should not be 0 (0 means, no checksum is used)
+    chksum = 0xffff;
+  return (uint16_t)chksum;
+}
+
+// folds a 32-bit sum into a 16-bit one's complement sum (without complementing it, as required for the pseudo header checksum)
+inline uint16_t foldChksum(uint32_t chksum)
+{
+  chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff);
+  chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff);
+  return (uint16_t)chksum;
+}
+
+// returns the next port number (Var: 0: fixed, 1: increasing, 2: decreasing, 3: pseudorandom)
+// port is preserved between the calls, when increase or decrease is done
+template <unsigned Var>
+inline uint16_t nextPort(uint16_t &port, uint16_t port_min, uint16_t port_max, RandomPorts &rand_ports)
+{
+  uint16_t p = port;
+  switch (Var)
+  {
+  case 1: // increasing port numbers
+    if (port++ == port_max)
+      port = port_min;
+    break;
+  case 2: // decreasing port numbers
+    if (port-- == port_min)
+      port = port_max;
+    break;
+  case 3: // pseudorandom port numbers
+    p = rand_ports.next(port_min, port_max);
+  }
+  return p;
+}
+
+// burst-mode transmission: up to burst_limit frames are prepared ahead, and then they are handed over to the NIC together,
+// when the first of them is due. As burst_limit <= tx_burst_size < num_of_templates, no template frame can occur twice in the same burst.
+// The segments of the frames are held (see holdFrame()) when they are added to the burst.
+// The frames of a burst are the consecutive frames of the slice of the sender, thus their ordinal numbers differ by stride.
+// Every frame of the slice must be passed (in order) to add() or sendAlone(), as they step the pacer (see pacer.h).
+class TxBurst
+{
+public:
+  uint8_t eth_id;                           // ethernet ID
+  uint16_t queue_id;                        // TX queue of the sender
+  uint16_t stride;                          // number of senders of the direction (difference of the ordinal numbers of the frames of the sender)
+  uint16_t burst_limit;                     // maximum number of frames in a burst (1 means precision mode)
+  Pacer pacer;                              // calculates the due times of the frames of the slice
+  uint64_t frames_to_send;                  // the pending burst is sent after the last frame anyway
+  struct rte_mbuf *tx_burst[MAX_PKT_BURST]; // the frames prepared for the next burst
+  uint16_t tx_pending;                      // the number of frames in the above array
+  uint64_t burst_first;                     // the ordinal number of the first frame of the pending (or the last sent) burst
+  uint64_t burst_due;                       // the due time of the above frame
+  struct txCounters *counters;              // the counters of the sender (see monitor.h)
+
+  TxBurst(uint8_t eth_id_, uint16_t queue_id_, uint16_t stride_, uint16_t burst_limit_, senderCommonParameters *cp, uint64_t frames_to_send_,
+          struct txCounters *counters_);
+
+  // adds a frame to the pending burst, and sends the burst, if it is full or this was the last frame of the sender
+  // returns the number of the frames sent (0, if the burst is still pending)
+  inline uint16_t add(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames)
+  {
+    uint64_t due = pacer.next();
+    holdFrame(pkt_mbuf);
+    if (tx_pending == 0)
+    {
+      burst_first = sent_frames;
+      burst_due = due;
+    }
+    tx_burst[tx_pending++] = pkt_mbuf;
+    if (tx_pending == burst_limit || sent_frames + stride >= frames_to_send)
+      return flush();
+    return 0;
+  }
+
+  // sends the pending burst, when its first frame is due
+  inline uint16_t flush()
+  {
+    uint16_t count = tx_pending;
+    if (count)
+    {
+      sendBurst(eth_id, queue_id, tx_burst, count, burst_due);
+      counters->sent += count;
+      tx_pending = 0;
+    }
+    return count;
+  }
+
+  // sends a frame individually at its own time (after the pending burst)
+  inline void sendAlone(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames)
+  {
+    flush();
+    holdFrame(pkt_mbuf);
+    sendBurst(eth_id, queue_id, &pkt_mbuf, 1, pacer.next());
+    counters->sent++;
+  }
+};
+
+// the state of the Test Frame generator of a sender
+class FrameGenerator
+{
+public:
+  senderParameters *p; // parameters of the sender
+  bool forward;        // test direction (forward or reverse)
+  bool chksum_offload; // the checksums are calculated by the NIC
+  bool frame_split;    // the frames consist of a header segment and a segment of the shared payload
+  unsigned var_sport, var_dport;
+  int mix; // MIX_BOTH, MIX_FG or MIX_BG
+  uint32_t n, m;
+  const CEHot6 *CE6;     // the hot records of the CEs (forward direction only)
+  const CEHot4 *CE4;     // the hot records of the CEs (reverse direction only)
+  uint32_t num_of_CEs;
+  const uint32_t *CE_stream; // the CE indices of the positions of the CE order (NULL in the sequential order, see ceorder.h)
+  uint32_t stream_length;    // the number of positions of the CE order (num_of_CEs in the sequential order)
+  uint16_t num_of_ports; // the number of ports in each port set
+
+  // temporary initial IP addresses put in the template frames; they are changed in the sending cycle
+  // (they are zero, thus the uncomplemented checksums of the template frames contain only the fixed fields)
+  uint32_t src_ipv4;              // the IPv4 address of the right interface of the Tester (fixed)
+  uint32_t zero_dst_ipv4;         // to be replaced by the IPv4 address of the CE
+  struct in6_addr zero_src_ipv6;  // to be replaced by the MAP address of the CE
+  struct in6_addr *dst_ipv6;      // the DMR IPv6 address (fixed)
+  struct in6_addr *src_bg, *dst_bg; // the addresses of the background frames (fixed)
+
+  int num_of_templates;                 // number of the template frames of each kind (see templateCount())
+  FrameFields *fg_frames, *bg_frames;   // the template frames
+  struct rte_mbuf *payload;             // the shared payload segment of the template frames (frame split mode only)
+
+  // port numbers
+  uint16_t port_min, port_max;  // the preconfigured range of the port not restricted to a port set (dport in forward, sport in reverse)
+  uint16_t port;                // its current value
+  uint16_t *curr_port_for_ps;   // the current value of the port restricted to the port set of the CE (sport in forward, dport in reverse)
+  uint16_t bg_sport_min, bg_sport_max, bg_dport_min, bg_dport_max;
+  uint16_t bg_sport, bg_dport;  // current port numbers of the background frames
+
+  int i;               // index of the next template frame: takes {0..num_of_templates-1} values
+  uint32_t current_CE; // the current position in the CE order (the index of the current simulated CE in the sequential order)
+  uint32_t prefetch_CE; // the position of the CE prefetched CE_PREFETCH frames ahead of the current one
+  RandomPorts rand_ports;
+
+  uint64_t first_frame; // the ordinal number of the first frame of the slice of the sender (its queue_id)
+  uint16_t stride;      // the number of senders of the direction
+
+  FrameGenerator(senderParameters *p_);
+  ~FrameGenerator();
+  // creates the foreground and background template frames (the latter by mkBgFrame6, if it is given)
+  void mkTemplates(mkFrame4Fn mkFrame4, mkFrame6Fn mkFrame6, mkFrame6Fn mkBgFrame6 = NULL);
+
+  // sets the fields of a new frame of the sender (see frameFields()), and splits it in frame split mode, using the given shared payload
+  FrameFields prepareFrame(struct rte_mbuf *pkt_mbuf, bool ipv4, struct rte_mbuf **shared_payload);
+
+  // waits until the NIC releases a template frame, if it still owns an earlier copy of it (see the write after send problem)
+  inline void reclaim(struct rte_mbuf *pkt_mbuf)
+  {
+    if (unlikely(rte_mbuf_refcnt_read(pkt_mbuf) > 1))
+      waitRelease(pkt_mbuf);
+  }
+  void waitRelease(struct rte_mbuf *pkt_mbuf);
+
+  // generates and sends the frames of the slice of the sender, whose ordinal number is less than frames_to_send, according to the measurement type
+  template <class Measure>
+  void run(Measure &meas, uint64_t frames_to_send);
+
+private:
+  template <bool Forward, class Measure>
+  void runOffload(Measure &meas, uint64_t frames_to_send);
+  template <bool Forward, bool Offload, class Measure>
+  void runVarSport(Measure &meas, uint64_t frames_to_send);
+  template <bool Forward, bool Offload, unsigned VarSport, class Measure>
+  void runVarDport(Measure &meas, uint64_t frames_to_send);
+  template <bool Forward, bool Offload, unsigned VarSport, unsigned VarDport, class Measure>
+  void runMix(Measure &meas, uint64_t frames_to_send);
+  template <bool Forward, bool Offload, unsigned VarSport, unsigned VarDport, int Mix, class Measure>
+  void loop(Measure &meas, uint64_t frames_to_send);
+};
+
+template <class Measure>
+void FrameGenerator::run(Measure &meas, uint64_t frames_to_send)
+{
+  if (forward)
+    runOffload<true>(meas, frames_to_send);
+  else
+    runOffload<false>(meas, frames_to_send);
+}
+
+template <bool Forward, class Measure>
+void FrameGenerator::runOffload(Measure &meas, uint64_t frames_to_send)
+{
+  if (chksum_offload)
+    runVarSport<Forward, true>(meas, frames_to_send);
+  else
+    runVarSport<Forward, false>(meas, frames_to_send);
+}
+
+template <bool Forward, bool Offload, class Measure>
+void FrameGenerator::runVarSport(Measure &meas, uint64_t frames_to_send)
+{
+  switch (var_sport)
+  {
+  case 0:
+    runVarDport<Forward, Offload, 0>(meas, frames_to_send);
+    break;
+  case 1:
+    runVarDport<Forward, Offload, 1>(meas, frames_to_send);
+    break;
+  case 2:
+    runVarDport<Forward, Offload, 2>(meas, frames_to_send);
+    break;
+  default:
+    runVarDport<Forward, Offload, 3>(meas, frames_to_send);
+  }
+}
+
+template <bool Forward, bool Offload, unsigned VarSport, class Measure>
+void FrameGenerator::runVarDport(Measure &meas, uint64_t frames_to_send)
+{
+  switch (var_dport)
+  {
+  case 0:
+    runMix<Forward, Offload, VarSport, 0>(meas, frames_to_send);
+    break;
+  case 1:
+    runMix<Forward, Offload, VarSport, 1>(meas, frames_to_send);
+    break;
+  case 2:
+    runMix<Forward, Offload, VarSport, 2>(meas, frames_to_send);
+    break;
+  default:
+    runMix<Forward, Offload, VarSport, 3>(meas, frames_to_send);
+  }
+}
+
+template <bool Forward, bool Offload, unsigned VarSport, unsigned VarDport, class Measure>
+void FrameGenerator::runMix(Measure &meas, uint64_t frames_to_send)
+{
+  switch (mix)
+  {
+  case MIX_FG:
+    loop<Forward, Offload, VarSport, VarDport, MIX_FG>(meas, frames_to_send);
+    break;
+  case MIX_BG:
+    loop<Forward, Offload, VarSport, VarDport, MIX_BG>(meas, frames_to_send);
+    break;
+  default:
+    loop<Forward, Offload, VarSport, VarDport, MIX_BOTH>(meas, frames_to_send);
+  }
+}
+
+// the sending cycle
+template <bool Forward, bool Offload, unsigned VarSport, unsigned VarDport, int Mix, class Measure>
+void FrameGenerator::loop(Measure &meas, uint64_t frames_to_send)
+{
+  uint64_t sent_frames;      // counts the number of sent frames
+  FrameFields *f;            // the frame to be updated and sent
+  bool fg;                   // foreground or background frame
+  bool tagged;               // special frame of the measurement (not one of the template frames)
+  uint16_t psid;             // the PSID of the current simulated CE
+  uint16_t ps_min, ps_max;   // the port range of the above port set
+  uint16_t sp, dp;           // values of source and destination port numbers
+  uint32_t chksum;           // temporary variable for UDP checksum (or pseudo header checksum) calculation
+  uint32_t no_chksum = 0;    // the measurement specific fields are added to it in checksum offload mode
+
+  for (sent_frames = first_frame; sent_frames < frames_to_send; sent_frames += stride)
+  {
+    fg = Mix == MIX_FG || (Mix == MIX_BOTH && sent_frames % n < m);
+    f = meas.tagged(sent_frames, fg);
+    tagged = f != NULL;
+    if (!tagged)
+    {
+      f = fg ? &fg_frames[i] : &bg_frames[i];
+      reclaim(f->pkt_mbuf);
+    }
+    chksum = f->udp_chksum_start; // restore the uncomplemented UDP (or pseudo header) checksum to add the values of the varying fields
+
+    if (fg)
+    {
+      // foreground frame: its addresses are those of the current CE, and the port number range of one of its ports is that of its port set
+      if (Forward)
+      {
+        const CEHot6 *ce = &CE6[CE_stream ? CE_stream[current_CE] : current_CE];
+        psid = ce->psid;
+        ps_min = (uint16_t)(psid * num_of_ports);
+        ps_max = (uint16_t)(ps_min + num_of_ports - 1);
+        *f->src_ipv6 = ce->map_addr;    // set it with the map address
+        chksum += ce->map_addr_chksum;  // and add its checksum to the UDP checksum
+        sp = nextPort<VarSport>(curr_port_for_ps[psid], ps_min, ps_max, rand_ports);
+        dp = nextPort<VarDport>(port, port_min, port_max, rand_ports);
+      }
+      else
+      {
+        const CEHot4 *ce = &CE4[CE_stream ? CE_stream[current_CE] : current_CE];
+        psid = ce->psid;
+        ps_min = (uint16_t)(psid * num_of_ports);
+        ps_max = (uint16_t)(ps_min + num_of_ports - 1);
+        *f->dst_ipv4 = ce->ipv4_addr;    // set it with the CE's IPv4 address
+        chksum += ce->ipv4_addr_chksum;  // add its chechsum to the UDP checksum
+        if (!Offload)
+          *f->ipv4_chksum = finishChksum(f->ipv4_chksum_start + ce->ipv4_addr_chksum); // and to the IPv4 header checksum
+        sp = nextPort<VarSport>(port, port_min, port_max, rand_ports);
+        dp = nextPort<VarDport>(curr_port_for_ps[psid], ps_min, ps_max, rand_ports);
+      }
+    }
+    else
+    {
+      // background frame: only its port numbers change
+      sp = nextPort<VarSport>(bg_sport, bg_sport_min, bg_sport_max, rand_ports);
+      dp = nextPort<VarDport>(bg_dport, bg_dport_min, bg_dport_max, rand_ports);
+    }
+    if (VarSport)
+    {
+      *f->udp_sport = htons(sp); // set the source port
+      if (!Offload)
+        chksum += *f->udp_sport; // and add it to the UDP checksum
+    }
+    if (VarDport)
+    {
+      *f->udp_dport = htons(dp); // set the destination port
+      if (!Offload)
+        chksum += *f->udp_dport; // and add it to the UDP checksum
+    }
+    meas.patch(f, sent_frames, Offload ? no_chksum : chksum);
+    if (!Offload)
+      *f->udp_chksum = finishChksum(chksum); // set the UDP checksum in the frame
+    else if (fg)
+      *f->udp_chksum = foldChksum(chksum); // set the pseudo header checksum (it is constant in the background frames)
+
+    meas.send(f->pkt_mbuf, sent_frames, tagged);
+
+    if ((current_CE += stride) >= stream_length) // proceed to the next CE of the slice in the CE order
+      current_CE %= stream_length;
+    if (Mix != MIX_BG)
+    {
+      // the hot record of a CE is prefetched while CE_PREFETCH frames are sent before its use
+      if ((prefetch_CE += stride) >= stream_length)
+        prefetch_CE %= stream_length;
+      uint32_t ahead = CE_stream ? CE_stream[prefetch_CE] : prefetch_CE;
+      rte_prefetch0(Forward ? (const void *)&CE6[ahead] : (const void *)&CE4[ahead]);
+    }
+    if (!tagged && ++i == num_of_templates)
+      i = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,112 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "hdrhist.h"
+
+// allocates the buckets of the histogram of a receiver in the memory of its NUMA node
+HdrHistogram::HdrHistogram(int socket_id, const char *direction)
+{
+  total = 0;
+  max = 0;
+  counts = (uint64_t *)rte_zmalloc_socket("latency histogram", HDR_BUCKETS * sizeof(uint64_t), RTE_CACHE_LINE_SIZE, socket_id);
+  if (!counts)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the latency histogram of a %s receiver!\n", direction);
+}
+
+HdrHistogram::~HdrHistogram()
+{
+  rte_free(counts);
+}
+
+// the buckets below 2*HDR_SUB_BUCKETS hold a single value, the width of the others doubles in every HDR_SUB_BUCKETS buckets
+uint64_t HdrHistogram::lowest(int b)
+{
+  if (b < 2 * HDR_SUB_BUCKETS)
+    return b;
+  int shift = b / HDR_SUB_BUCKETS - 1;
+  return (uint64_t)(b - shift * HDR_SUB_BUCKETS) << shift;
+}
+
+uint64_t HdrHistogram::highest(int b)
+{
+  int shift = b < 2 * HDR_SUB_BUCKETS ? 0 : b / HDR_SUB_BUCKETS - 1;
+  return lowest(b) + (1ULL << shift) - 1;
+}
+
+void HdrHistogram::add(const HdrHistogram *other)
+{
+  total += other->total;
+  if (other->max > max)
+    max = other->max;
+  for (int b = 0; b < HDR_BUCKETS; b++)
+    counts[b] += other->counts[b];
+}
+
+// the p-th percentile is the value of the ceil(p/100*total)-th smallest recorded value
+// The highest value of its bucket is reported, but not more than the largest recorded value.
+uint64_t HdrHistogram::percentile(double p)
+{
+  uint64_t rank = (uint64_t)ceil(p / 100 * total), sum = 0;
+  if (rank < 1)
+    rank = 1;
+  for (int b = 0; b < HDR_BUCKETS; b++)
+    if ((sum += counts[b]) >= rank)
+      return highest(b) < max ? highest(b) : max;
+  return max;
+}
+
+void HdrHistogram::dump(const char *direction)
+{
+  char filename[64];
+  FILE *f;
+  snprintf(filename, sizeof(filename), "%s-%s.csv", HDR_FILE, direction);
+  if (!(f = fopen(filename, "w")))
+  {
+    std::cerr << "Error: could not create the latency histogram file '" << filename << "'." << std::endl;
+    return;
+  }
+  fprintf(f, "lowest latency (ns),highest latency (ns),frames\n");
+  for (int b = 0; b < HDR_BUCKETS; b++)
+    if (counts[b])
+      fprintf(f, "%lu,%lu,%lu\n", lowest(b), highest(b), counts[b]);
+  fclose(f);
+  printf("Info: %s latency histogram was written into '%s'\n", direction, filename);
+}
+
+// The Typical Latency and the Worst Case Latency are also reported in the format of the tagged Latency Frames (in milliseconds),
+// but the lost frames are simply missing from the histogram (instead of being counted with a penalty).
+void reportHistograms(HdrHistogram **histograms, int num_of_receivers, const char *direction)
+{
+  HdrHistogram *sum = histograms[0];
+  for (int q = 1; q < num_of_receivers; q++)
+    sum->add(histograms[q]);
+  if (!sum->total)
+  {
+    printf("Warning: %s latency histogram: no foreground frames were received after the delay before timestamps\n", direction);
+    return;
+  }
+  printf("Info: %s latency histogram: frames: %lu, median: %lu ns, 99th: %lu ns, 99.9th: %lu ns, 99.99th: %lu ns, max: %lu ns\n",
+         direction, sum->total, sum->percentile(50), sum->percentile(99), sum->percentile(99.9), sum->percentile(99.99), sum->max);
+  printf("%s TL: %lf\n", direction, sum->percentile(50) / 1000000.0);    // Typical Latency
+  printf("%s WCL: %lf\n", direction, sum->percentile(99.9) / 1000000.0); // Worst Case Latency
+  sum->dump(direction);
+}
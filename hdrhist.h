@@ -0,0 +1,87 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HDRHIST_H_INCLUDED
+#define HDRHIST_H_INCLUDED
+
+// Latency histogram of all the foreground frames (optional, maptperf-lat only, see 'Latency-histogram' in the configuration file)
+//
+// Instead of the num_of_tagged Latency Frames, every foreground frame is a Latency Frame carrying its TX timestamp (the TSC
+// value, when its burst is due) in the 8 bytes after the identifier. The receivers take a timestamp after each rte_eth_rx_burst(),
+// and record the latency of the foreground frames sent after first_tagged_delay into their own histograms, thus the memory
+// needed is independent of the number of frames. The background frames keep the identifier of the Test Frames (they also
+// carry a timestamp, as the measurement policy does not know the kind of the frame, but it is not recorded).
+//
+// The histogram is log-linear (like HdrHistogram): the latencies (in nanoseconds) below 2^HDR_PRECISION_BITS are counted
+// exactly, and each further power of 2 range is divided into HDR_SUB_BUCKETS buckets of equal width, thus the relative
+// error of a value is less than 2^-(HDR_PRECISION_BITS-1). The percentiles are reported as the highest value of their bucket.
+// The histograms of the receivers of a direction are added together, and the non-empty buckets are written into
+// HDR_FILE-<direction>.csv. As the bucket boundaries are fixed, the histograms of several tests can be merged
+// by adding the counts of the rows with the same boundaries.
+// Remark: the latency is measured from the time the frame was due (and not from the time it was actually sent), thus
+// a sender lagging behind its schedule increases the latency of the frames instead of hiding them (coordinated omission).
+
+#define HDR_PRECISION_BITS 10                            // the number of significant bits of the recorded values
+#define HDR_MAX_BITS 42                                  // values of at least 2^HDR_MAX_BITS nanoseconds (73 minutes) are recorded as the largest one
+#define HDR_SUB_BUCKETS (1 << (HDR_PRECISION_BITS - 1))  // the number of buckets of each power of 2 range
+#define HDR_BUCKETS ((HDR_MAX_BITS - HDR_PRECISION_BITS + 2) * HDR_SUB_BUCKETS) // the number of buckets of the histogram
+#define HDR_FILE "latency-histogram"                     // prefix of the name of the CSV files
+
+class HdrHistogram
+{
+public:
+  HdrHistogram(int socket_id, const char *direction);
+  ~HdrHistogram();
+
+  // records a latency (in nanoseconds)
+  inline void record(uint64_t value)
+  {
+    if (value > max)
+      max = value;
+    if (unlikely(value >> HDR_MAX_BITS))
+      value = (1ULL << HDR_MAX_BITS) - 1;
+    counts[bucket(value)]++;
+    total++;
+  }
+
+  void add(const HdrHistogram *other); // adds the counts of an other histogram to this one
+  uint64_t percentile(double p);        // the highest value of the bucket of the p-th percentile (p: 0-100)
+  void dump(const char *direction);     // writes the non-empty buckets into HDR_FILE-<direction>.csv
+
+  // the bucket of a value: the bits below its HDR_PRECISION_BITS most significant bits are dropped
+  static inline int bucket(uint64_t value)
+  {
+    int shift = 63 - __builtin_clzll(value | 1) - (HDR_PRECISION_BITS - 1);
+    if (shift < 0)
+      shift = 0;
+    return shift * HDR_SUB_BUCKETS + (int)(value >> shift);
+  }
+  static uint64_t lowest(int b);  // the lowest value of a bucket
+  static uint64_t highest(int b); // the highest value of a bucket
+
+  uint64_t total;   // the number of recorded values
+  uint64_t max;     // the largest recorded value (exact)
+  uint64_t *counts; // the number of values in each bucket
+};
+
+// adds the histograms of the receivers of a direction together, reports the percentiles, and writes the histogram into a file
+void reportHistograms(HdrHistogram **histograms, int num_of_receivers, const char *direction);
+
+#endif
@@ -25,6 +25,7 @@
 #include <numa.h>
 #include <random>
 #include <iostream>
+#include <string>
 #include <algorithm>
 #include <rte_lcore.h>
 #include <rte_mempool.h>
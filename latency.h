@@ -21,6 +21,8 @@
 #ifndef LATENCY_H_INCLUDED
 #define LATENCY_H_INCLUDED
 
+class HdrHistogram; // see hdrhist.h
+
 // the main class for latency measurements, adds some features to class Throughput
 class Latency : public Throughput
 {
@@ -30,10 +32,12 @@ public:
 
   Latency() : Throughput(){};                    // default constructor
   int readCmdLine(int argc, const char *argv[]); // reads further two arguments
-  virtual int senderPoolSize();                  // adds num_of_tagged, too
+  virtual int senderPoolSize(int num_of_templates); // adds num_of_tagged, too
+  void addCELatencies(CEStats *stats, uint64_t *send_ts, uint64_t *receive_ts); // adds the latencies of the Latency Frames to the per-CE statistics
 
   // perform latency measurement
   void measure(uint16_t leftport, uint16_t rightport);
+  void measureHistogram(uint16_t leftport, uint16_t rightport); // every foreground frame is timestamped (see hdrhist.h)
 };
 
 // functions to create Latency Frames (and their parts)
@@ -45,6 +49,15 @@ struct rte_mbuf *mkLatencyFrame6(uint16_t length, rte_mempool *pkt_pool, const c
                                  const struct ether_addr *dst_mac, const struct ether_addr *src_mac,
                                  const struct in6_addr *src_ip, const struct in6_addr *dst_ip, unsigned var_sport, unsigned var_dport, uint16_t id);
 
+// functions to create the foreground frames of the latency histogram (see hdrhist.h)
+struct rte_mbuf *mkStampFrame4(uint16_t length, rte_mempool *pkt_pool, const char *direction,
+                               const struct ether_addr *dst_mac, const struct ether_addr *src_mac,
+                               const uint32_t *src_ip, uint32_t *dst_ip, unsigned var_sport, unsigned var_dport);
+void mkDataStamp(uint8_t *data, uint16_t length);
+struct rte_mbuf *mkStampFrame6(uint16_t length, rte_mempool *pkt_pool, const char *direction,
+                               const struct ether_addr *dst_mac, const struct ether_addr *src_mac,
+                               struct in6_addr *src_ip, struct in6_addr *dst_ip, unsigned var_sport, unsigned var_dport);
+
 class senderCommonParametersLatency : public senderCommonParameters
 {
 public:
@@ -52,30 +65,47 @@ public:
   uint16_t num_of_tagged; // The number of tagged frames
 
   senderCommonParametersLatency(uint16_t ipv6_frame_size_, uint16_t ipv4_frame_size_, uint32_t frame_rate_, uint16_t test_duration_,
-                                uint32_t n_, uint32_t m_, uint64_t hz_, uint64_t start_tsc_, uint32_t num_of_CEs_, uint16_t num_of_port_sets_,
+                                uint32_t n_, uint32_t m_, uint64_t hz_, uint64_t start_tsc_, uint32_t num_of_CEs_, uint32_t num_of_port_sets_,
                                 uint16_t num_of_ports_, struct in6_addr *tester_l_ipv6_, uint32_t *tester_r_ipv4_, struct in6_addr *dmr_ipv6_,
                                 struct in6_addr *tester_r_ipv6_, uint16_t bg_sport_min_, uint16_t bg_sport_max_, uint16_t bg_dport_min_, uint16_t bg_dport_max_,
-                                uint16_t first_tagged_delay_, uint16_t num_of_tagged_);
+                                uint16_t tx_burst_size_, uint16_t tx_max_skew_, uint32_t frame_ring_mb_,
+                                int pacer_profile_, uint16_t pacer_burst_, uint16_t pacer_period_, uint16_t pacer_amplitude_, uint16_t first_tagged_delay_, uint16_t num_of_tagged_);
 };
 
 class senderParametersLatency : public senderParameters
 {
 public:
-  uint64_t *send_ts; // pointer to the send timestamps
-  senderParametersLatency(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, const char *direction_,
-                          CE_data *CE_array_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
-                          uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_,
-                          uint64_t *send_ts_);
+  uint64_t *send_ts;    // pointer to the send timestamps
+  uint64_t *send_hw_ts; // pointer to the hardware send timestamps (NULL, if they are not used, see timestamp.h)
+  senderParametersLatency(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, uint16_t queue_id_, uint16_t num_of_queues_, const char *direction_,
+                          struct txCounters *counters_, const void *hot_CEs_, const CEOrder *ce_order_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
+                          uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_, bool chksum_offload_, bool frame_split_,
+                          int num_of_templates_, uint64_t *send_ts_, uint64_t *send_hw_ts_);
 };
 
 class receiverParametersLatency : public receiverParameters
 {
 public:
   uint16_t num_of_tagged;
-  uint64_t *receive_ts; // pointer to the receive timestamps
-  receiverParametersLatency(uint64_t finish_receiving_, uint8_t eth_id_, const char *direction_, uint16_t num_of_tagged_, uint64_t *receive_ts_);
+  uint64_t *receive_ts; // pointer to the receive timestamps (own shard of the receiver)
+  uint64_t *receive_hw_ts; // pointer to the hardware receive timestamps (own shard of the receiver, NULL if they are not used)
+  receiverParametersLatency(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                            Validator *validator_, CEStats *ce_stats_, uint16_t num_of_tagged_, uint64_t *receive_ts_, uint64_t *receive_hw_ts_);
 };
 
+class receiverParametersHistogram : public receiverParameters
+{
+public:
+  HdrHistogram *histogram; // the latency histogram of the receiver
+  uint64_t record_from;    // the foreground frames due earlier are not recorded (the end of first_tagged_delay)
+  uint64_t hz;             // the frequency of the TSC
+  receiverParametersHistogram(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                              Validator *validator_, CEStats *ce_stats_, HdrHistogram *histogram_, uint64_t record_from_, uint64_t hz_);
+};
+
+// merges the receive timestamp shards of the receivers of a direction into the first one
+void mergeTimestamps(uint64_t **receive_ts, int num_of_receivers, uint16_t num_of_tagged);
+
 void evaluateLatency(uint16_t num_of_tagged, uint64_t *send_ts, uint64_t *receive_ts, uint64_t hz, int penalty, const char *direction);
 
 #endif
@@ -32,5 +32,8 @@ int main(int argc, const char **argv)
     return -1;
   if (tester.init(argv[0], LEFTPORT, RIGHTPORT) < 0)
     return -1;
-  tester.measure(LEFTPORT, RIGHTPORT);
+  if (tester.search)
+    tester.binarySearch(LEFTPORT, RIGHTPORT);
+  else
+    tester.measure(LEFTPORT, RIGHTPORT);
 }
@@ -0,0 +1,113 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "mapaddr.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// synthesizes a single CE
+static inline void synthesizeCE(CE_data *CE, EAbits48 ea, const MapRule *rule)
+{
+  uint64_t end_user_ipv6_prefix = ((rule->rule_prefix << rule->bmr_ipv4_suffix_length | ea.ip4_suffix) << rule->psid_length) | ea.psid;
+  uint64_t interface_id = ((uint64_t)ntohl(rule->bmr_ipv4_prefix) | ea.ip4_suffix) << 16 | ea.psid;
+  uint64_t *map_addr = (uint64_t *)CE->map_addr.s6_addr;
+  CE->psid = ea.psid;
+  CE->ipv4_addr = rule->bmr_ipv4_prefix | htonl(ea.ip4_suffix);
+  CE->ipv4_addr_chksum = rte_raw_cksum(&CE->ipv4_addr, 4);
+  map_addr[0] = rte_cpu_to_be_64(end_user_ipv6_prefix);
+  map_addr[1] = rte_cpu_to_be_64(interface_id);
+  CE->map_addr_chksum = rte_raw_cksum(map_addr, 16);
+}
+
+#ifdef __AVX2__
+static_assert(sizeof(EAbits48) == 8, "MAPADDR_LANES EA-bits combinations are loaded as a single AVX2 register");
+
+// sums up the 16-bit words of each 32-bit lane of x into the lane
+static inline __m256i sumWords32(__m256i x)
+{
+  return _mm256_add_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0xffff)), _mm256_srli_epi32(x, 16));
+}
+
+// adds up the two 32-bit partial sums of each 64-bit lane of x (they are less than 2^31), and reduces the result to 16 bits
+static inline __m256i foldChksum64(__m256i x)
+{
+  const __m256i low16 = _mm256_set1_epi64x(0xffff);
+  x = _mm256_add_epi64(_mm256_and_si256(x, _mm256_set1_epi64x(0xffffffff)), _mm256_srli_epi64(x, 32));
+  x = _mm256_add_epi64(_mm256_and_si256(x, low16), _mm256_srli_epi64(x, 16));
+  return _mm256_add_epi64(_mm256_and_si256(x, low16), _mm256_srli_epi64(x, 16));
+}
+
+void synthesizeCEs(CE_data *CE, const EAbits48 *ea, uint32_t n, const MapRule *rule)
+{
+  // converts each 64-bit lane into network byte order
+  const __m256i bswap64 = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                           7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  const __m256i low32 = _mm256_set1_epi64x(0xffffffff);
+  const __m128i psid_shift = _mm_cvtsi32_si128(rule->psid_length);
+  const __m256i prefix = _mm256_set1_epi64x(rule->rule_prefix << (rule->bmr_ipv4_suffix_length + rule->psid_length));
+  const __m256i ipv4_prefix = _mm256_set1_epi64x(ntohl(rule->bmr_ipv4_prefix));
+  alignas(32) uint64_t ipv4_addr[MAPADDR_LANES], ipv4_chksum[MAPADDR_LANES], map_chksum[MAPADDR_LANES];
+  uint32_t i;
+
+  for (i = 0; i + MAPADDR_LANES <= n; i += MAPADDR_LANES)
+  {
+    __m256i ea_bits = _mm256_loadu_si256((const __m256i *)(ea + i)); // lanes: the suffix in bits 0-31, the PSID in bits 32-47
+    __m256i suffix = _mm256_and_si256(ea_bits, low32);
+    __m256i psid = _mm256_and_si256(_mm256_srli_epi64(ea_bits, 32), _mm256_set1_epi64x(0xffff));
+    __m256i end_user = _mm256_or_si256(_mm256_or_si256(prefix, _mm256_sll_epi64(suffix, psid_shift)), psid);
+    __m256i interface_id = _mm256_or_si256(_mm256_slli_epi64(_mm256_or_si256(ipv4_prefix, suffix), 16), psid);
+    end_user = _mm256_shuffle_epi8(end_user, bswap64);
+    interface_id = _mm256_shuffle_epi8(interface_id, bswap64);
+
+    // the IPv4 address in network byte order is in bytes 2-5 of the interface ID
+    __m256i ipv4 = _mm256_and_si256(_mm256_srli_epi64(interface_id, 16), low32);
+    _mm256_store_si256((__m256i *)ipv4_addr, ipv4);
+    _mm256_store_si256((__m256i *)ipv4_chksum, foldChksum64(sumWords32(ipv4)));
+    _mm256_store_si256((__m256i *)map_chksum, foldChksum64(_mm256_add_epi32(sumWords32(end_user), sumWords32(interface_id))));
+
+    // the MAP addresses of the CEs i, i+2 and i+1, i+3 are in the interleaved lanes
+    __m256i even = _mm256_unpacklo_epi64(end_user, interface_id);
+    __m256i odd = _mm256_unpackhi_epi64(end_user, interface_id);
+    _mm_storeu_si128((__m128i *)CE[i].map_addr.s6_addr, _mm256_castsi256_si128(even));
+    _mm_storeu_si128((__m128i *)CE[i + 1].map_addr.s6_addr, _mm256_castsi256_si128(odd));
+    _mm_storeu_si128((__m128i *)CE[i + 2].map_addr.s6_addr, _mm256_extracti128_si256(even, 1));
+    _mm_storeu_si128((__m128i *)CE[i + 3].map_addr.s6_addr, _mm256_extracti128_si256(odd, 1));
+    for (int k = 0; k < MAPADDR_LANES; k++)
+    {
+      CE[i + k].psid = ea[i + k].psid;
+      CE[i + k].ipv4_addr = (uint32_t)ipv4_addr[k];
+      CE[i + k].ipv4_addr_chksum = (uint16_t)ipv4_chksum[k];
+      CE[i + k].map_addr_chksum = (uint32_t)map_chksum[k];
+    }
+  }
+  for (; i < n; i++)
+    synthesizeCE(&CE[i], ea[i], rule);
+}
+#else
+void synthesizeCEs(CE_data *CE, const EAbits48 *ea, uint32_t n, const MapRule *rule)
+{
+  for (uint32_t i = 0; i < n; i++)
+    synthesizeCE(&CE[i], ea[i], rule);
+}
+#endif
@@ -0,0 +1,49 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPADDR_H_INCLUDED
+#define MAPADDR_H_INCLUDED
+
+// Synthesis of the addresses of the simulated CEs from their EA-bits (see buildCEArray())
+//
+// For each CE, the IPv4 address (the BMR IPv4 prefix and the IPv4 suffix), the MAP address (RFC 7599):
+//   - end user IPv6 prefix (64 bits): the BMR Rule IPv6 Prefix, the IPv4 suffix and the PSID
+//   - interface ID (64 bits): 16 zero bits, the IPv4 address and the PSID
+// and the 16-bit one's complement sums of both addresses (to be added to the header checksums later) are computed.
+// If the CPU has AVX2 instructions, MAPADDR_LANES CEs are synthesized at once: the two 64-bit halves of their MAP
+// addresses are computed in 64-bit lanes, converted into network byte order by a byte shuffle, and the checksums are
+// summed up from the shuffled lanes, thus the results are the same as those of the scalar code (and of rte_raw_cksum()).
+
+#define MAPADDR_LANES 4 // number of CEs synthesized at once (one AVX2 register of 64-bit lanes)
+#define MAPADDR_BATCH 64 // number of CEs enumerated and synthesized together by buildCEArray() (a multiple of MAPADDR_LANES)
+
+// the constants of the Basic Mapping Rule needed for the synthesis
+struct MapRule
+{
+  uint64_t rule_prefix;          // the BMR's Rule IPv6 Prefix as an integer of bmr_ipv6_prefix_length bits
+  uint32_t bmr_ipv4_prefix;      // the BMR's IPv4 prefix (in network byte order)
+  uint8_t bmr_ipv4_suffix_length; // the BMR's IPv4 suffix length
+  uint8_t psid_length;           // the number of the BMR's PSID bits
+};
+
+// fills in the addresses and checksums of n CEs (the PSID too) from their EA-bits combinations
+void synthesizeCEs(CE_data *CE, const EAbits48 *ea, uint32_t n, const MapRule *rule);
+
+#endif
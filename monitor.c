@@ -0,0 +1,135 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "monitor.h"
+
+// prepares the sampling of the intervals of [start_tsc, finish_tsc]
+Monitor::Monitor(uint32_t interval_, uint64_t hz_, uint64_t start_tsc_, uint64_t finish_tsc_)
+{
+  interval = interval_;
+  hz = hz_;
+  start_tsc = start_tsc_;
+  finish_tsc = finish_tsc_;
+  num_of_samples = (finish_tsc - start_tsc) * 1000 / (hz * interval) + 1;
+  num_taken = 0;
+  num_of_directions = 0;
+  sample_tsc = new uint64_t[num_of_samples];
+}
+
+Monitor::~Monitor()
+{
+  for (int d = 0; d < num_of_directions; d++)
+  {
+    delete[] dirs[d].sent;
+    delete[] dirs[d].received;
+  }
+  delete[] sample_tsc;
+}
+
+// adds an active direction
+void Monitor::addDirection(const char *direction, struct txCounters *tx_counters, int num_of_senders, struct rxCounters *rx_counters, int num_of_receivers)
+{
+  MonitorDirection *d = &dirs[num_of_directions++];
+  d->direction = direction;
+  d->tx_counters = tx_counters;
+  d->num_of_senders = num_of_senders;
+  d->rx_counters = rx_counters;
+  d->num_of_receivers = num_of_receivers;
+  d->sent = new uint64_t[num_of_samples];
+  d->received = new uint64_t[num_of_samples];
+}
+
+// samples the counters at the end of each interval (the main lcore has nothing else to do meanwhile)
+// The counters are read through volatile pointers, as they are written by the senders and receivers.
+void Monitor::run()
+{
+  uint64_t per_line = MONITOR_PRINT / interval ? MONITOR_PRINT / interval : 1; // the number of intervals per printed line
+  uint64_t printed = 0;                                                         // the last sample printed so far
+  for (uint64_t k = 0; k < num_of_samples; k++)
+  {
+    uint64_t due = start_tsc + k * hz * interval / 1000;
+    while (rte_rdtsc() < due)
+      rte_pause();
+    sample_tsc[k] = rte_rdtsc();
+    for (int d = 0; d < num_of_directions; d++)
+    {
+      MonitorDirection *dir = &dirs[d];
+      uint64_t sent = 0, received = 0;
+      for (int q = 0; q < dir->num_of_senders; q++)
+        sent += *(volatile uint64_t *)&dir->tx_counters[q].sent;
+      for (int q = 0; q < dir->num_of_receivers; q++)
+        received += *(volatile uint64_t *)&dir->rx_counters[q].received;
+      dir->sent[k] = sent;
+      dir->received[k] = received;
+    }
+    num_taken = k + 1;
+    if (k - printed == per_line || (k == num_of_samples - 1 && k > printed))
+    {
+      print(printed, k);
+      printed = k;
+    }
+  }
+}
+
+// prints the frame rates and the loss of the intervals between two samples
+void Monitor::print(uint64_t first, uint64_t last)
+{
+  double seconds = (double)(sample_tsc[last] - sample_tsc[first]) / hz; // the actual length of the intervals
+  printf("Monitor: %.3lf s:", (double)(sample_tsc[last] - start_tsc) / hz);
+  for (int d = 0; d < num_of_directions; d++)
+  {
+    uint64_t sent = dirs[d].sent[last] - dirs[d].sent[first];
+    int64_t lost = sent - (dirs[d].received[last] - dirs[d].received[first]);
+    printf("%s %s sent: %.0lf fps, received: %.0lf fps, loss: %.3lf%%", d ? ";" : "", dirs[d].direction,
+           sent / seconds, (dirs[d].received[last] - dirs[d].received[first]) / seconds, sent ? 100.0 * lost / sent : 0.0);
+  }
+  printf("\n");
+}
+
+// writes the numbers of the frames sent and received in each interval into MONITOR_FILE
+void Monitor::write()
+{
+  FILE *f;
+  if (!(f = fopen(MONITOR_FILE, "w")))
+  {
+    std::cerr << "Error: could not create the monitor file '" << MONITOR_FILE << "'." << std::endl;
+    return;
+  }
+  fprintf(f, "time (ms)");
+  for (int d = 0; d < num_of_directions; d++)
+    fprintf(f, ",%s sent,%s received,%s loss (%%)", dirs[d].direction, dirs[d].direction, dirs[d].direction);
+  fprintf(f, "\n");
+  for (uint64_t k = 1; k < num_taken; k++)
+  {
+    fprintf(f, "%.3lf", 1000.0 * (sample_tsc[k] - start_tsc) / hz);
+    for (int d = 0; d < num_of_directions; d++)
+    {
+      uint64_t sent = dirs[d].sent[k] - dirs[d].sent[k - 1];
+      uint64_t received = dirs[d].received[k] - dirs[d].received[k - 1];
+      fprintf(f, ",%lu,%lu,%.3lf", sent, received, sent ? 100.0 * ((int64_t)sent - (int64_t)received) / sent : 0.0);
+    }
+    fprintf(f, "\n");
+  }
+  fclose(f);
+  printf("Info: the monitored time series was written into '%s'\n", MONITOR_FILE);
+}
@@ -0,0 +1,73 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MONITOR_H_INCLUDED
+#define MONITOR_H_INCLUDED
+
+// Live traffic monitor (optional, see 'Monitor-interval' in the configuration file)
+//
+// While the senders and receivers are running, the main lcore would only wait for them, so nothing could be seen of
+// a warm-up dip, a periodic stall or a collapse of the DUT during the test. Instead, the main lcore samples the counters
+// of the senders and receivers (txCounters and rxCounters, see throughput.h) every Monitor-interval milliseconds.
+// Each counter has a single writer and occupies its own cache line, and the data-plane lcores only increment them
+// (the senders after each burst, the receivers after each received burst), thus monitoring costs them nothing more.
+// The differences of the consecutive samples are the numbers of frames sent and received in the intervals:
+//   - they are printed live, summed up for about every second (MONITOR_PRINT milliseconds)
+//   - and they are written into MONITOR_FILE for each interval, after the test
+// The loss of an interval is the number of frames sent minus the number of frames received in it, relative to the
+// former. As the frames in flight are received in the next interval, it is only an estimate (it may be even negative).
+
+#define MONITOR_FILE "monitor.csv" // name of the CSV file of the time series
+#define MONITOR_PRINT 1000         // the period of the printed lines (milliseconds, at least one interval)
+
+// the counters of an active direction
+struct MonitorDirection
+{
+  const char *direction;
+  struct txCounters *tx_counters; // the counters of the senders of the direction
+  int num_of_senders;
+  struct rxCounters *rx_counters; // the counters of the receivers of the direction
+  int num_of_receivers;
+  uint64_t *sent, *received;      // the samples of the sums of the counters (one per interval)
+};
+
+class Monitor
+{
+public:
+  Monitor(uint32_t interval_, uint64_t hz_, uint64_t start_tsc_, uint64_t finish_tsc_);
+  ~Monitor();
+  void addDirection(const char *direction, struct txCounters *tx_counters, int num_of_senders, struct rxCounters *rx_counters, int num_of_receivers);
+  void run();   // samples the counters from start_tsc until finish_tsc, and prints the time series
+  void write(); // writes the time series into MONITOR_FILE
+
+private:
+  void print(uint64_t first, uint64_t last); // prints the sums of the intervals (first, last]
+  uint32_t interval;         // the length of an interval (milliseconds)
+  uint64_t hz;               // the frequency of the TSC
+  uint64_t start_tsc;        // the start of the first interval (the start of sending)
+  uint64_t finish_tsc;       // the end of the last interval (the end of receiving)
+  uint64_t num_of_samples;   // the number of the samples: one at start_tsc and one at the end of each interval
+  uint64_t num_taken;        // the number of the samples taken so far
+  uint64_t *sample_tsc;      // the actual times of the samples
+  int num_of_directions;
+  MonitorDirection dirs[2];
+};
+
+#endif
@@ -0,0 +1,152 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "pacer.h"
+
+// calculates the length of the offset table of a profile, returns 0, if the parameters are invalid
+uint64_t pacerTableSize(int profile, uint16_t burst, uint16_t period, uint32_t frame_rate)
+{
+  uint64_t size;
+  switch (profile)
+  {
+  case PACER_CBR:
+    return 1;
+  case PACER_POISSON:
+    return PACER_POISSON_TABLE;
+  case PACER_ONOFF:
+    return burst;
+  case PACER_SINE:
+    size = ((uint64_t)frame_rate * period + 500) / 1000; // the number of frames in a period
+    return size >= 2 && size <= PACER_MAX_TABLE ? size : 0;
+  default:
+    return 0;
+  }
+}
+
+Pacer::Pacer(senderCommonParameters *cp, uint64_t first_frame, uint16_t stride)
+{
+  start_tsc = cp->start_tsc;
+  hz = cp->hz;
+  frame_rate = cp->frame_rate;
+
+  // the CBR schedule: frame k is due at start_tsc + k*hz/frame_rate (first_frame < stride, thus there is no overflow)
+  due_int = start_tsc + first_frame * hz / frame_rate;
+  due_frac = first_frame * hz % frame_rate;
+  step_int = stride * hz / frame_rate;
+  step_frac = stride * hz % frame_rate;
+
+  table_size = pacerTableSize(cp->pacer_profile, cp->pacer_burst, cp->pacer_period, frame_rate);
+  if (!table_size)
+    rte_exit(EXIT_FAILURE, "Error: Invalid parameters of the pacer!\n");
+  offset = new int64_t[table_size];
+  switch (cp->pacer_profile)
+  {
+  case PACER_POISSON:
+    poissonTable();
+    break;
+  case PACER_ONOFF:
+    onOffTable(cp->pacer_burst);
+    break;
+  case PACER_SINE:
+    sineTable(cp->pacer_amplitude);
+    break;
+  default:
+    offset[0] = 0;
+  }
+  pos = first_frame % table_size;
+  pos_step = stride % table_size;
+}
+
+Pacer::~Pacer()
+{
+  delete[] offset;
+}
+
+// Poisson arrivals: the arrival time of frame j (in frames) is the sum of j exponentially distributed inter-arrival times,
+// which are scaled so that their total is exactly table_size
+void Pacer::poissonTable()
+{
+  std::mt19937_64 gen(PACER_SEED);
+  std::exponential_distribution<double> gap(1.0);
+  double *arrival = new double[table_size + 1];
+  arrival[0] = 0;
+  for (uint32_t j = 0; j < table_size; j++)
+    arrival[j + 1] = arrival[j] + gap(gen);
+  double scale = table_size / arrival[table_size];
+  for (uint32_t j = 0; j < table_size; j++)
+    offset[j] = llround((arrival[j] * scale - j) * hz / frame_rate);
+  delete[] arrival;
+}
+
+// on/off microbursts: frame j of a burst is due at the time of the first frame of the burst
+void Pacer::onOffTable(uint16_t burst)
+{
+  for (uint32_t j = 0; j < burst; j++)
+    offset[j] = -llround((double)j * hz / frame_rate);
+}
+
+// sinusoidal load: the number of frames due until time u (measured in frames) is u + c*(1-cos(w*u)), where w = 2*pi/table_size
+// and c = a/w, thus the frame rate is frame_rate*(1+a*sin(w*u)); the arrival time of frame j is calculated by Newton's method
+void Pacer::sineTable(uint16_t amplitude)
+{
+  double a = amplitude / 100.0;
+  double w = 2 * M_PI / table_size;
+  double c = a / w;
+  double u = 0; // the arrival time of the current frame
+  for (uint32_t j = 0; j < table_size; j++)
+  {
+    // the root is in [u, u+1/(1-a)], as the function grows at least by 1-a per frame (from j-1 at the previous root)
+    double lo = u, hi = u + 1 / (1 - a);
+    for (int iter = 0; iter < 100; iter++)
+    {
+      double g = u + c * (1 - cos(w * u)) - j;
+      if (g < 0)
+        lo = u;
+      else
+        hi = u;
+      double next = u - g / (1 + a * sin(w * u));
+      if (next <= lo || next >= hi)
+        next = (lo + hi) / 2; // fall back to bisection, if Newton's step leaves the bracket
+      bool done = fabs(next - u) < 1e-9;
+      u = next;
+      if (done)
+        break;
+    }
+    offset[j] = llround((u - j) * hz / frame_rate);
+  }
+}
+
+// calculates the due time of any frame (it contains division, thus it is not for the sending cycle)
+// (the whole seconds are separated, because frame*hz could overflow at high frame rates)
+uint64_t Pacer::dueTsc(uint64_t frame)
+{
+  return start_tsc + frame / frame_rate * hz + frame % frame_rate * hz / frame_rate + offset[frame % table_size];
+}
+
+// calculates the maximum allowed time of sending in seconds: the TOLERANCE is applied to the test duration, or to the
+// due time of the last frame, if that is later (it may be so with Poisson arrivals)
+double Pacer::timeLimit(uint16_t test_duration, uint64_t frames_to_send)
+{
+  double last_due = frames_to_send ? (double)(dueTsc(frames_to_send - 1) - start_tsc) / hz : 0;
+  return std::max((double)test_duration, last_due) * TOLERANCE;
+}
@@ -0,0 +1,106 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACER_H_INCLUDED
+#define PACER_H_INCLUDED
+
+// Traffic pacer of the senders: it tells when the frames are due
+//
+// The due time of frame k is start_tsc + k*hz/frame_rate + offset[k % L], where the first term is the constant bit rate
+// (CBR) schedule, and the offset table of L elements describes the arrival profile. The sum of the offsets is such that
+// every L frames take exactly L/frame_rate seconds, thus the average frame rate of all the profiles is the same.
+// The CBR term is calculated incrementally by a fixed-point (integer + fraction) accumulator: a sender adds its stride
+// times hz/frame_rate to it for each frame, thus the sending cycle contains neither multiplication nor division,
+// and it can not overflow even in the longest tests at the highest frame rates.
+//
+// Arrival profiles (the offset table is calculated before sending):
+//   PACER_CBR:     constant bit rate, every frame is sent at its own time (L = 1)
+//   PACER_POISSON: Poisson arrivals: exponentially distributed inter-arrival times, which are scaled so that
+//                  PACER_POISSON_TABLE frames take exactly their nominal time (the pseudorandom sequence is the same in every test)
+//   PACER_ONOFF:   on/off microbursts: the frames of a burst of 'Pacer-burst' frames are all due at the time of its first frame
+//                  (they are sent back-to-back), and then the sender is idle until the next burst is due
+//   PACER_SINE:    sinusoidal load: the instantaneous frame rate is frame_rate*(1+a*sin(2*pi*t/T)), where a is 'Pacer-amplitude'
+//                  percent, and T is 'Pacer-period' milliseconds (rounded to whole frames)
+// The frames of the CBR, on/off and sinusoidal profiles are never due later than with CBR. The Poisson frames may be,
+// therefore the time limit of sending is calculated from the due time of the last frame (see timeLimit()).
+// Remark: 'TX-max-skew' is enforced on the basis of the average frame rate.
+
+#define PACER_CBR 0
+#define PACER_POISSON 1
+#define PACER_ONOFF 2
+#define PACER_SINE 3
+
+#define PACER_POISSON_TABLE 65536  // number of the inter-arrival times of the Poisson profile (repeated cyclically)
+#define PACER_MAX_TABLE (1 << 22)  // maximum number of offsets (limits the period of the sinusoidal profile)
+#define PACER_SEED 20230101        // seed of the Poisson profile, thus the tests are repeatable
+
+// calculates the length of the offset table of a profile, returns 0, if the parameters are invalid
+uint64_t pacerTableSize(int profile, uint16_t burst, uint16_t period, uint32_t frame_rate);
+
+// the pacer of a sender: calculates the due times of the frames of its slice (first_frame, first_frame+stride, ...) in order
+class Pacer
+{
+public:
+  Pacer(class senderCommonParameters *cp, uint64_t first_frame, uint16_t stride);
+  ~Pacer();
+
+  // returns the due time of the next frame of the slice, and steps the accumulator to the following one
+  inline uint64_t next()
+  {
+    uint64_t due = due_int + offset[pos];
+    due_int += step_int;
+    if ((due_frac += step_frac) >= frame_rate)
+    {
+      due_frac -= frame_rate;
+      due_int++;
+    }
+    if ((pos += pos_step) >= table_size)
+      pos -= table_size;
+    return due;
+  }
+
+  // returns the due time of the next frame of the slice without stepping the accumulator
+  inline uint64_t peek() const
+  {
+    return due_int + offset[pos];
+  }
+
+  uint64_t dueTsc(uint64_t frame);                                  // calculates the due time of any frame (not for the sending cycle)
+  double timeLimit(uint16_t test_duration, uint64_t frames_to_send); // the maximum allowed time of sending in seconds
+
+private:
+  void poissonTable(); // calculate the offset tables of the profiles
+  void onOffTable(uint16_t burst);
+  void sineTable(uint16_t amplitude);
+
+  uint64_t start_tsc;   // the sending of the frames begins at this time
+  uint64_t hz;          // number of clock cycles per second
+  uint32_t frame_rate;  // number of frames per second
+  uint64_t due_int;     // the CBR due time of the next frame: due_int + due_frac/frame_rate
+  uint64_t due_frac;    // (due_frac < frame_rate)
+  uint64_t step_int;    // the CBR distance of the frames of the slice: step_int + step_frac/frame_rate
+  uint64_t step_frac;   // (step_frac < frame_rate)
+  int64_t *offset;      // the offset table of the profile (in clock cycles)
+  uint32_t table_size;  // number of its elements
+  uint32_t pos;         // the position of the offset of the next frame
+  uint32_t pos_step;    // stride % table_size
+};
+
+#endif
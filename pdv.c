@@ -21,6 +21,15 @@
 #include "defines.h"
 #include "includes.h"
 #include "throughput.h"
+#include "randport.h"
+#include "pacer.h"
+#include "generator.h"
+#include "classifier.h"
+#include "eatable.h"
+#include "validator.h"
+#include "ceorder.h"
+#include "cestats.h"
+#include "timestamp.h"
 #include "pdv.h"
 
 // the understanding of this code requires the knowledge of throughput.c
@@ -109,6 +118,31 @@ void mkDataPdv(uint8_t *data, uint16_t length)
     data[i] = i % 256;
 }
 
+// measurement policy of the PDV test: every frame carries its serial number, and its sending timestamp is stored (see generator.h)
+class MeasurePdv
+{
+public:
+  TxBurst &tx;
+  uint64_t *snd_ts; // sending timestamps of the frames
+  MeasurePdv(TxBurst &tx_, uint64_t *snd_ts_) : tx(tx_), snd_ts(snd_ts_){};
+  inline FrameFields *tagged(uint64_t sent_frames, bool fg) { return NULL; }
+  inline void patch(FrameFields *f, uint64_t sent_frames, uint32_t &chksum)
+  {
+    *f->counter = sent_frames;                // set the counter in the frame
+    chksum += rte_raw_cksum(&sent_frames, 8); // add the checksum of the counter to the accumulated checksum value
+  }
+  inline void send(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames, bool tagged)
+  {
+    uint16_t sent = tx.add(pkt_mbuf, sent_frames);
+    if (sent)
+    {
+      uint64_t timestamp = rte_rdtsc();
+      for (int j = 0; j < sent; j++)
+        snd_ts[tx.burst_first + j * tx.stride] = timestamp; // store the same timestamp for all the frames of the burst
+    }
+  }
+};
+
 // sends Test Frames for PDV measurements
 int sendPdv(void *par)
 {
@@ -117,627 +151,311 @@ int sendPdv(void *par)
   class senderCommonParameters *cp = (class senderCommonParameters *)p->cp;
 
   // parameters directly correspond to the data members of class Throughput
-  uint16_t ipv6_frame_size = cp->ipv6_frame_size;
-  uint16_t ipv4_frame_size = cp->ipv4_frame_size;
   uint32_t frame_rate = cp->frame_rate;
   uint16_t test_duration = cp->test_duration;
-  uint32_t n = cp->n;
-  uint32_t m = cp->m;
   uint64_t hz = cp->hz;
   uint64_t start_tsc = cp->start_tsc;
-  uint32_t num_of_CEs = cp->num_of_CEs;
-  uint16_t num_of_port_sets = cp->num_of_port_sets;
-  uint16_t num_of_ports = cp->num_of_ports;
- struct in6_addr *tester_l_ipv6 = cp->tester_l_ipv6;
-  uint32_t *tester_r_ipv4 = cp->tester_r_ipv4;
-  struct in6_addr *dmr_ipv6 = cp->dmr_ipv6;
-  struct in6_addr *tester_r_ipv6 = cp->tester_r_ipv6;
-  uint16_t bg_dport_min = cp->bg_dport_min; 
-  uint16_t bg_dport_max = cp->bg_dport_max; 
-  uint16_t bg_sport_min = cp->bg_sport_min; 
-  uint16_t bg_sport_max = cp->bg_sport_max;
+  uint16_t tx_burst_size = cp->tx_burst_size;
+  uint16_t tx_max_skew = cp->tx_max_skew;
 
   // parameters which are different for the Left sender and the Right sender
-  rte_mempool *pkt_pool = p->pkt_pool;
   uint8_t eth_id = p->eth_id;
+  uint16_t queue_id = p->queue_id;
+  uint16_t num_of_queues = p->num_of_queues;
   const char *direction = p->direction;
-  CE_data *CE_array = p->CE_array;
-  struct ether_addr *dst_mac = p->dst_mac;
-  struct ether_addr *src_mac = p->src_mac;
-  unsigned var_sport = p->var_sport;
-  unsigned var_dport = p->var_dport;
-  uint16_t preconfigured_port_min = p->preconfigured_port_min;
-  uint16_t preconfigured_port_max = p->preconfigured_port_max;
 
-  uint64_t **send_ts = p->send_ts;
+  uint64_t *snd_ts = p->send_ts; // the senders of the direction store the timestamps of their own frames into the common array
 
-  
   // further local variables
-  uint64_t frames_to_send = test_duration * frame_rate; // Each active sender sends this number of frames
-  uint64_t sent_frames = 0;                             // counts the number of sent frames
-  double elapsed_seconds;                               // for checking the elapsed seconds during sending
-
-  // temperoray initial IP addresses that will be put in the template packets and they will be changed later in the sending loop
-  // useful to calculate correct checksums 
-  //(more specifically, the uncomplemented checksum start value after calculating it by the DPDK rte_ipv4_cksum(), rte_ipv4_udptcp_cksum(), and rte_ipv6_udptcp_cksum() functions
-  // when creating the template packets)
-  uint32_t zero_dst_ipv4;
-  struct in6_addr zero_src_ipv6;
-  
-  // the dst_ipv4 must initially be "0.0.0.0" in order for the ipv4 header checksum to be calculated correctly by The rte_ipv4_cksum() 
-  // and for the udp checksum to be calculated correctly the rte_ipv4_udptcp_cksum()
- // and consequently calculate correct checksums in the mKTestFrame4()
-  if (inet_pton(AF_INET, "0.0.0.0", reinterpret_cast<void *>(&zero_dst_ipv4)) != 1)
-  {
-    std::cerr << "Input Error: Bad virt_dst_ipv4 address." << std::endl;
-    return -1;
-  }
+  uint64_t frames_to_send = (uint64_t)test_duration * frame_rate;                        // The senders of an active direction send this number of frames together
+  uint64_t own_frames = (frames_to_send + num_of_queues - 1 - queue_id) / num_of_queues; // This sender sends every num_of_queues-th of them
+  double elapsed_seconds;                                                                // for checking the elapsed seconds during sending
+  double time_limit;                                                                     // the maximum allowed elapsed seconds (see pacer.h)
 
-  // the src_ipv6 must initially be "::" for the udp checksum to be calculated correctly by the rte_ipv6_udptcp_cksum
-  // and consequently calculate correct checksum in the mKTestFrame6()
-  if (inet_pton(AF_INET6, "::", reinterpret_cast<void *>(&zero_src_ipv6)) != 1)
-  {
-    std::cerr << "Input Error: Bad  virt_src_ipv6 address." << std::endl;
-    return -1;
-  }
-  
-  // These addresses are for the foreground traffic in the reverse direction
-  // setting the source ipv4 address of the reverse direction to the ipv4 address of the tester right interface
-  uint32_t *src_ipv4 = tester_r_ipv4;// This would be set without change during testing in the reverse direction.
-                                       // It will represent the ipv4 address of the right interface of the Tester
-  *src_ipv4 = htonl(*src_ipv4);
-  
-  uint32_t *dst_ipv4 = &zero_dst_ipv4; // This would be variable during testing in the reverse direction.
-                                       // It will represent the simulated CE (BMR-ipv4-prefix + suffix)
-                                       // and is merely specified inside the sending loop using the CE_array
-
-  // These addresses are for the foreground traffic in the forward direction
-  struct in6_addr *src_ipv6 = &zero_src_ipv6; // This would be variable during testing in the forward direction.
-                                              // It will represent the simulated CE (MAP address) 
-                                              //and is merely specified inside the sending loop using the CE_array
-                                               
-  struct in6_addr *dst_ipv6 = dmr_ipv6; // This would be set without change during testing in the forward direction.
-                                        // It will represent the DMR IPv6 address.
-
-  // These addresses are for the background traffic only
-  struct in6_addr *src_bg = (direction == "forward" ? tester_l_ipv6 : tester_r_ipv6);  
-  struct in6_addr *dst_bg = (direction == "forward" ? tester_r_ipv6 : tester_l_ipv6); 
-  
-  uint16_t sport_min, sport_max, dport_min, dport_max; // worker port range variables
-  
-// set the relevant ranges to the wide range prespecified in the configuration file (usually comply with RFC 4814)
-// the other ranges that are not set now. They will be set in the sending loop because they are based on the PSID of the
-//pseudorandomly enumerated CE
-  if (direction == "reverse")
-    {
-      sport_min = preconfigured_port_min;
-      sport_max = preconfigured_port_max;
-    }
-  else //forward
-    {
-      dport_min = preconfigured_port_min;
-      dport_max = preconfigured_port_max;
-    }
-  
-  // check whether the CE array is built or not
-   if(!CE_array)
-    rte_exit(EXIT_FAILURE,"No CE array can be accessed by the %s sender",direction);
-    
-
-  // prepare a NUMA local, cache line aligned array for send timestamps
-  uint64_t *snd_ts = (uint64_t *)rte_malloc(0, 8 * frames_to_send, 128);
-  if (!snd_ts)
-    rte_exit(EXIT_FAILURE, "Error: Receiver can't allocate memory for timestamps!\n");
-  *send_ts = snd_ts; // return the address of the array to the caller function
-
-  // implementation of varying port numbers recommended by RFC 4814 https://tools.ietf.org/html/rfc4814#section-4.5
-  // RFC 4814 requires pseudorandom port numbers, increasing and decreasing ones are our additional, non-stantard solutions
-  // always the same foreground or background frame is sent, but it is updated regarding counter
-  //source and/or destination IP addresses and port number(s), and UDP and IPv4 header checksum are updated
-  // N size arrays are used to resolve the write after send problem
-  
-  //some worker variables
-  int i;                                                       // cycle variable for the above mentioned purpose: takes {0..N-1} values
-  int current_CE;                                              // index variable to the current simulated CE in the CE_array
-  uint16_t psid;                                               // Temporary variable for the ID of the randomly selected port set for the simulated CE
-  struct rte_mbuf *fg_pkt_mbuf[N], *bg_pkt_mbuf[N], *pkt_mbuf; // message buffers for fg. and bg. Test Frames
-  uint8_t *pkt;                                                // working pointer to the current frame (in the message buffer)
-  
-  //IP workers
-  uint32_t *fg_dst_ipv4[N];
-  struct in6_addr *fg_src_ipv6[N];
-  struct in6_addr *bg_src_ipv6[N], *bg_dst_ipv6[N];
-  uint16_t *fg_ipv4_chksum[N]; 
-
-  //UDP workers
-  uint16_t *fg_udp_sport[N], *fg_udp_dport[N], *fg_udp_chksum[N], *bg_udp_sport[N], *bg_udp_dport[N], *bg_udp_chksum[N];
-  uint16_t *udp_sport, *udp_dport, *udp_chksum; 
-
-  uint16_t fg_udp_chksum_start, bg_udp_chksum_start, fg_ipv4_chksum_start; // starting values (uncomplemented checksums taken from the original frames created by mKTestFrame functions)
-  uint32_t chksum = 0; // temporary variable for UDP checksum calculation
-  uint32_t ip_chksum = 0; //temporary variable for IPv4 header checksum calculation
-  uint16_t sport, dport, bg_sport, bg_dport; // values of source and destination port numbers -- to be preserved, when increase or decrease is done
-  uint16_t sp, dp;                           // values of source and destination port numbers -- temporary values
-
-  uint64_t *fg_counter[N], *bg_counter[N]; // pointers to the given fields
-  uint64_t *counter;                       // working pointer to the counter in the currently manipulated frame
+  FrameGenerator gen(p); // the Test Frame generator (see generator.h)
+  TxBurst tx(eth_id, queue_id, num_of_queues, burstLimit(tx_burst_size, tx_max_skew, frame_rate, num_of_queues), cp, frames_to_send, p->counters);
 
   // create buffers of template PDV Test Frames
-  for (i = 0; i < N; i++)
-  {
-    // create foreground PDV Frame (IPv4 or IPv6)
-    if (direction == "reverse")
-    {
+  // always one of the same pre-prepared foreground or background template frames is updated regarding the counter, and sent
+  gen.mkTemplates(mkPdvFrame4, mkPdvFrame6);
 
-      fg_pkt_mbuf[i] = mkPdvFrame4(ipv4_frame_size, pkt_pool, direction, dst_mac, src_mac, src_ipv4, dst_ipv4, var_sport, var_dport);
-      pkt = rte_pktmbuf_mtod(fg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-      // the source ipv4 address will not be manipulated as it will permenantly be the tester-right-ipv4 (extracted from the dmr-ipv6 as done above)
-      fg_ipv4_chksum[i] = (uint16_t *)(pkt + 24);
-      fg_dst_ipv4[i] = (uint32_t *)(pkt + 30); // The destination ipv4 should be manipulated in the sending loop as it will be the BMR-ipv4-prefix + suffix (i.e. changine each time) in the reverse direction
-      // The source address will not be manipulated as it will permentantly be the IP address of the right interface of the Tester (as done in the initilization above)
-      fg_udp_sport[i] = (uint16_t *)(pkt + 34);
-      fg_udp_dport[i] = (uint16_t *)(pkt + 36);
-      fg_udp_chksum[i] = (uint16_t *)(pkt + 40);
-      fg_counter[i] = (uint64_t *)(pkt + 50);
-    }
-    else
-    { //"forward"
-      fg_pkt_mbuf[i] = mkPdvFrame6(ipv6_frame_size, pkt_pool, direction, dst_mac, src_mac, src_ipv6, dst_ipv6, var_sport, var_dport);
-      pkt = rte_pktmbuf_mtod(fg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-      fg_src_ipv6[i] = (struct in6_addr *)(pkt + 22);    // The source address should be manipulated as it will be the MAP address (i.e. changing each time) in the forward direction
-      // The destination address will not be manipulated as it will permenantly be the DMR IPv6 address (as done in the initilization above)
-      fg_udp_sport[i] = (uint16_t *)(pkt + 54);
-      fg_udp_dport[i] = (uint16_t *)(pkt + 56);
-      fg_udp_chksum[i] = (uint16_t *)(pkt + 60);
-      fg_counter[i] = (uint64_t *)(pkt + 70);
-    }
-
-    // Always create a backround Test Frame (it is always an IPv6 frame) regardless of the direction of the test
-    // The source and destination IP addresses of the packet have already been set in the initialization above
-    // and they will permenantely be the IP addresses of the left and right interfaces of the Tester 
-    // and based on the direction of the test 
-    bg_pkt_mbuf[i] = mkPdvFrame6(ipv6_frame_size, pkt_pool, direction, dst_mac, src_mac, src_bg, dst_bg, var_sport, var_dport);
-    pkt = rte_pktmbuf_mtod(bg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-    bg_udp_sport[i] = (uint16_t *)(pkt + 54);
-    bg_udp_dport[i] = (uint16_t *)(pkt + 56);
-    bg_udp_chksum[i] = (uint16_t *)(pkt + 60);
-    bg_counter[i] = (uint64_t *)(pkt + 70);
-  }
-  //save the uncomplemented UDP checksum value (same for all values of [i]). So, [0] is enough
-  fg_udp_chksum_start = ~*fg_udp_chksum[0]; // for the foreground frames 
-  bg_udp_chksum_start = ~*bg_udp_chksum[0]; // same but for the background frames
-  
-  // save the uncomplementd IPv4 header checksum (same for all values of [i]). So, [0] is enough
-  if (direction == "reverse") // in case of foreground IPv4 only
-      fg_ipv4_chksum_start = ~*fg_ipv4_chksum[0]; 
-
-  // arrays to store the minimum and maximum possible souce and destination port numbers in each port set.
-  uint16_t sport_min_for_ps[num_of_port_sets], sport_max_for_ps[num_of_port_sets], dport_min_for_ps[num_of_port_sets], dport_max_for_ps[num_of_port_sets];
-
-  // arrays of indices to know the current source and destination port numbers for each port set, to be used in case of incrementing or decrementing
-  uint16_t curr_sport_for_ps[num_of_port_sets];  // used to restore the last used sport in the port set to set the next sport to.
-  uint16_t curr_dport_for_ps[num_of_port_sets];  // used to restore the last used dport in the port set to set the next dport to.
-  uint16_t curr_sport_for_bg, curr_dport_for_bg; // used to restore the last used port in the background traffic in case the sport or dport are modified in the range of a port set
-
-  for (i = 0; i < num_of_port_sets; i++)
-  {
-    // set the port boundaries for each port set
-    sport_min_for_ps[i] = (uint16_t)(i * num_of_ports);
-    sport_max_for_ps[i] = (uint16_t)((i + 1) * num_of_ports) - 1;
-
-    dport_min_for_ps[i] = (uint16_t)(i * num_of_ports);
-    dport_max_for_ps[i] = (uint16_t)((i + 1) * num_of_ports) - 1;
-
-    // set the initial values of port numbers for each port set, depending whether they will be increased or decreased
-    if (var_sport == 1)
-      curr_sport_for_ps[i] = sport_min_for_ps[i];
-    if (var_dport == 1)
-      curr_dport_for_ps[i] = dport_min_for_ps[i];
-    if (var_sport == 2)
-      curr_sport_for_ps[i] = sport_max_for_ps[i];
-    if (var_dport == 2)
-      curr_dport_for_ps[i] = dport_max_for_ps[i];
-  }
-
-  // The sport and dport values are initialized according to wide range of values.
-  // However, for the foreground packets, in the forward direction, the sport_min and sport_max will be set later in the sending loop based on the generated PSID
-  // in the reverse direction, the dport_min and dport_max will be set later in the sending loop based on the generated PSID
-  // No change for bg_sport and bg_dport in case of the background packets.
-  if (var_sport == 1)
-  {
-    sport = sport_min;
-    bg_sport = bg_sport_min;
-  }
-  if (var_sport == 2)
-  {
-    sport = sport_max;
-    bg_sport = bg_sport_max;
-  }
-  if (var_dport == 1)
-  {
-    dport = dport_min;
-    bg_dport = bg_dport_min;
-  }
-  if (var_dport == 2)
-  {
-    dport = dport_max;
-    bg_dport = bg_dport_max;
-  }
-
-
-  i = 0; // increase maunally after each sending
-  current_CE = 0; // increase maunally after each sending
-
-  // prepare random number infrastructure
-  thread_local std::random_device rd_sport;           // Will be used to obtain a seed for the random number engines
-  thread_local std::mt19937_64 gen_sport(rd_sport()); // Standard 64-bit mersenne_twister_engine seeded with rd()
-  thread_local std::random_device rd_dport;           // Will be used to obtain a seed for the random number engines
-  thread_local std::mt19937_64 gen_dport(rd_dport()); // Standard 64-bit mersenne_twister_engine seeded with rd()
-
-  // naive sender version: it is simple and fast
-  for (sent_frames = 0; sent_frames < frames_to_send; sent_frames++)
-  { // Main cycle for the number of frames to send
-    // set the temporary variables (including several pointers) to handle the right pre-generated Test Frame
-
-    if (sent_frames % n < m)
-    {
-      // foreground frame is to be sent
-
-      psid = CE_array[current_CE].psid;
-      chksum = fg_udp_chksum_start; // restore the uncomplemented UDP checksum to add the values of the varying fields
-      udp_sport = fg_udp_sport[i];
-      udp_dport = fg_udp_dport[i];
-      udp_chksum = fg_udp_chksum[i];
-      counter = fg_counter[i];
-      pkt_mbuf = fg_pkt_mbuf[i];
-
-      if (direction == "forward")
-      {
-
-        *fg_src_ipv6[i] = CE_array[current_CE].map_addr; // set it with the map address
-        chksum += CE_array[current_CE].map_addr_chksum; // and add it to the UDP checksum
-
-        // the sport_min and sport_max will be set according to the port range values of the selected port set and the sport will retrieve its last value within this range
-        // the dport_min and dport_max will remain on thier default values within the wide range. The dport will be changed based on its value from the last cycle.
-        sport_min = sport_min_for_ps[psid];
-        sport_max = sport_max_for_ps[psid];
-        if (var_sport == 1 || var_sport == 2)
-          sport = curr_sport_for_ps[psid]; // restore the last used sport in the ps to start over from it (useful when increment or decrement; useless when random)
-      }
-
-      if (direction == "reverse")
-      {
-        ip_chksum = fg_ipv4_chksum_start;
-
-        *fg_dst_ipv4[i] = CE_array[current_CE].ipv4_addr; //set it with the CE's IPv4 address
-        
-        chksum += CE_array[current_CE].ipv4_addr_chksum; //add its chechsum to the UDP checksum
-        ip_chksum += CE_array[current_CE].ipv4_addr_chksum; //and to the IPv4 header checksum
-
-        ip_chksum = ((ip_chksum & 0xffff0000) >> 16) + (ip_chksum & 0xffff); // calculate 16-bit one's complement sum
-        ip_chksum = ((ip_chksum & 0xffff0000) >> 16) + (ip_chksum & 0xffff); // Twice is enough
-        ip_chksum = (~ip_chksum) & 0xffff;                                   // make one's complement
-        if (ip_chksum == 0)                                                  // checksum should not be 0 (0 means, no checksum is used)
-          ip_chksum = 0xffff;
-        *fg_ipv4_chksum[i] = (uint16_t)ip_chksum; //now set the IPv4 header checksum of the packet
-
-        // the dport_min and dport_max will be set according to the port range values of the selected port set and the dport will retrieve its last value within this range
-        // the sport_min and sport_max will remain on thier default values within the wide range. The sport will be changed based on its value from the last cycle.
-        dport_min = dport_min_for_ps[psid];
-        dport_max = dport_max_for_ps[psid];
-        if (var_dport == 1 || var_dport == 2)
-          dport = curr_dport_for_ps[psid]; // restore the last used dport in the ps to start over from it (useful when increment or decrement; useless when random)
-      }
-   // time to change the value of the source and destination port numbers
-    if (var_sport)
-    {
-      // sport is varying
-      switch (var_sport)
-      {
-      case 1: // increasing port numbers
-        if ((sp = sport++) == sport_max)
-          sport = sport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((sp = sport--) == sport_min)
-          sport = sport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_sport(sport_min, sport_max); // uniform distribution in [sport_min, sport_max]
-        sp = uni_dis_sport(gen_sport);
-      }
-      *udp_sport = htons(sp); // set the source port 
-      chksum += *udp_sport; // and add it to the UDP checksum
-    }
-    if (var_dport)
-    {
-      // dport is varying
-      switch (var_dport)
-      {
-      case 1: // increasing port numbers
-        if ((dp = dport++) == dport_max)
-          dport = dport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((dp = dport--) == dport_min)
-          dport = dport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_dport(dport_min, dport_max); // uniform distribution in [sport_min, sport_max]
-        dp = uni_dis_dport(gen_dport);
-      }
-      *udp_dport = htons(dp); // set the destination port 
-      chksum += *udp_dport; // and add it to the UDP checksum
-    }
-    if (direction == "forward")
-        curr_sport_for_ps[psid] = sport; // save the current sport of the ps as a starting point for the later use if the same ps will be selected
-      else
-        curr_dport_for_ps[psid] = dport; // save the current dport of the ps as a starting point for the later use if the same ps will be selected
-    }
-    else
-    {
-      // background frame is to be sent
-      // from here, we need to handle the background frame identified by the temporary variables
-
-      chksum = bg_udp_chksum_start; // restore the uncomplemented UDP checksum to add the values of the varying fields
-      udp_sport = bg_udp_sport[i];
-      udp_dport = bg_udp_dport[i];
-      udp_chksum = bg_udp_chksum[i];
-      counter = bg_counter[i];
-      pkt_mbuf = bg_pkt_mbuf[i];
-
-      // time to change the value of the source and destination port numbers
-    if (var_sport)
-    {
-      // sport is varying
-      switch (var_sport)
-      {
-      case 1: // increasing port numbers
-        if ((sp = bg_sport++) == bg_sport_max)
-          bg_sport = bg_sport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((sp = bg_sport--) == bg_sport_min)
-          bg_sport = bg_sport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_sport(bg_sport_min, bg_sport_max); // uniform distribution in [sport_min, sport_max]
-        sp = uni_dis_sport(gen_sport);
-      }
-      *udp_sport = htons(sp); // set the source port 
-      chksum += *udp_sport; // and add it to the UDP checksum
-    }
-    if (var_dport)
-    {
-      // dport is varying
-      switch (var_dport)
-      {
-      case 1: // increasing port numbers
-        if ((dp = bg_dport++) == bg_dport_max)
-          bg_dport = bg_dport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((dp = bg_dport--) == bg_dport_min)
-          bg_dport = bg_dport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_dport(bg_dport_min, bg_dport_max); // uniform distribution in [sport_min, sport_max]
-        dp = uni_dis_dport(gen_dport);
-      }
-      *udp_dport = htons(dp); // set the destination port 
-      chksum += *udp_dport; // and add it to the UDP checksum
-    }
-    }
-    
-   
-    *counter = sent_frames;                   // set the counter in the frame
-    chksum += rte_raw_cksum(&sent_frames, 8); // add the checksum of the counter to the accumulated checksum value
-
-    chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // calculate 16-bit one's complement sum
-    chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // Twice is enough
-    chksum = (~chksum) & 0xffff;                                // make one's complement
-    
-    if (direction == "reverse")
-    {
-      if (chksum == 0)                                            // checksum should not be 0 (0 means, no checksum is used)
-        chksum = 0xffff;
-    }
-    *udp_chksum = (uint16_t)chksum; // set the UDP checksum in the frame
-
-    // finally, send the frame
-    while (rte_rdtsc() < start_tsc + sent_frames * hz / frame_rate)
-      ; // Beware: an "empty" loop, as well as in the next line
-    while (!rte_eth_tx_burst(eth_id, 0, &pkt_mbuf, 1))
-      ; // send out the frame
-
-    snd_ts[sent_frames] = rte_rdtsc(); // store timestamp
-    current_CE = (current_CE + 1) % num_of_CEs;
-    i = (i + 1) % N;
-  } // this is the end of the sending cycle
+  MeasurePdv meas(tx, snd_ts);
+  gen.run(meas, frames_to_send);
+  p->sent_frames = own_frames;
 
   // Now, we check the time
   elapsed_seconds = (double)(rte_rdtsc() - start_tsc) / hz;
-  printf("Info: %s sender's sending took %3.10lf seconds.\n", direction, elapsed_seconds);
-  if (elapsed_seconds > test_duration * TOLERANCE)
-    rte_exit(EXIT_FAILURE, "%s sending exceeded the %3.10lf seconds limit, the test is invalid.\n", direction, test_duration * TOLERANCE);
-  printf("%s frames sent: %lu\n", direction, sent_frames);
+  printf("Info: %s sender #%u's sending took %3.10lf seconds.\n", direction, queue_id, elapsed_seconds);
+  time_limit = tx.pacer.timeLimit(test_duration, frames_to_send);
+  if (elapsed_seconds > time_limit)
+    rte_exit(EXIT_FAILURE, "%s sending exceeded the %3.10lf seconds limit, the test is invalid.\n", direction, time_limit);
   return 0;
 }
 
-// Offsets from the start of the Ethernet Frame:
-// EtherType: 6+6=12
-// IPv6 Next header: 14+6=20, UDP Data for IPv6: 14+40+8=62
-// IPv4 Protolcol: 14+9=23, UDP Data for IPv4: 14+20+8=42
+// The bursts are classified by classifyBurst() (see classifier.h), and then the PDV Frames are visited individually.
+// Offsets of the counter from the start of the Ethernet Frame: IPv6: 14+40+8+8=70, IPv4: 14+20+8+8=50
 int receivePdv(void *par)
 {
   // collecting input parameters:
   class receiverParametersPdv *p = (class receiverParametersPdv *)par;
   uint64_t finish_receiving = p->finish_receiving;
   uint8_t eth_id = p->eth_id;
-  const char *direction = p->direction;
+  uint16_t queue_id = p->queue_id;
+  struct rxCounters *counters = p->counters;
   uint64_t num_frames = p->num_frames;
-  uint16_t frame_timeout = p->frame_timeout;
-  uint64_t **receive_ts = p->receive_ts;
+  uint64_t *rec_ts = p->receive_ts;
+  uint64_t *rec_hw_ts = p->receive_hw_ts;
 
   // further local variables
   int frames, i;
   uint64_t timestamp, counter;
   struct rte_mbuf *pkt_mbufs[MAX_PKT_BURST];                      // pointers for the mbufs of received frames
-  uint16_t ipv4 = htons(0x0800);                                  // EtherType for IPv4 in Network Byte Order
-  uint16_t ipv6 = htons(0x86DD);                                  // EtherType for IPv6 in Network Byte Order
   uint8_t identify[8] = {'I', 'D', 'E', 'N', 'T', 'I', 'F', 'Y'}; // Identificion of the Test Frames
   uint64_t *id = (uint64_t *)identify;
+  RxMasks pdv;           // the PDV Frames of the burst (see classifier.h)
+  uint32_t all;          // the PDV Frames of the burst (of both IP versions)
   uint64_t received = 0; // number of received frames
 
-  // prepare a NUMA local, cache line aligned array for reveive timestamps, and fill it with all 0-s
-  uint64_t *rec_ts = (uint64_t *)rte_zmalloc(0, 8 * num_frames, 128);
-  if (!rec_ts)
-    rte_exit(EXIT_FAILURE, "Error: Receiver can't allocate memory for timestamps!\n");
-  *receive_ts = rec_ts; // return the address of the array to the caller function
-
   while (rte_rdtsc() < finish_receiving)
   {
-    frames = rte_eth_rx_burst(eth_id, 0, pkt_mbufs, MAX_PKT_BURST);
-    for (i = 0; i < frames; i++)
+    frames = rte_eth_rx_burst(eth_id, queue_id, pkt_mbufs, MAX_PKT_BURST);
+    classifyBurst<1>(pkt_mbufs, frames, id, &pdv);
+    all = pdv.ipv6 | pdv.ipv4;
+    received += __builtin_popcount(all); // also count them
+    for (; all; all &= all - 1)
     {
-      uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], uint8_t *); // Access the PDV Frame in the message buffer
-      // check EtherType at offset 12: IPv6, IPv4, or anything else
-      if (*(uint16_t *)&pkt[12] == ipv6)
-      { /* IPv6 */
-        /* check if IPv6 Next Header is UDP, and the first 8 bytes of UDP data is 'IDENTIFY' */
-        if (likely(pkt[20] == 17 && *(uint64_t *)&pkt[62] == *id))
-        {
-          // PDV frame
-          timestamp = rte_rdtsc(); // get a timestamp ASAP
-          counter = *(uint64_t *)&pkt[70];
-          if (unlikely(counter >= num_frames))
-            rte_exit(EXIT_FAILURE, "Error: PDV Frame with invalid frame ID was received!\n"); // to avoid segmentation fault
-          rec_ts[counter] = timestamp;
-          received++; // also count it
-        }
-      }
-      else if (*(uint16_t *)&pkt[12] == ipv4)
-      { /* IPv4 */
-        if (likely(pkt[23] == 17 && *(uint64_t *)&pkt[42] == *id))
-        {
-          // Latency Frame
-          timestamp = rte_rdtsc(); // get a timestamp ASAP
-          counter = *(uint64_t *)&pkt[50];
-          if (unlikely(counter >= num_frames))
-            rte_exit(EXIT_FAILURE, "Error: PDV Frame with invalid frame ID was received!\n"); // to avoid segmentation fault
-          rec_ts[counter] = timestamp;
-          received++; // also count it
-        }
-      }
-      rte_pktmbuf_free(pkt_mbufs[i]);
+      timestamp = rte_rdtsc(); // get a timestamp ASAP
+      i = __builtin_ctz(all);  // the next PDV Frame of the burst
+      uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], uint8_t *);
+      counter = *(uint64_t *)&pkt[pdv.ipv6 & (1u << i) ? 70 : 50];
+      if (unlikely(counter >= num_frames))
+        rte_exit(EXIT_FAILURE, "Error: PDV Frame with invalid frame ID was received!\n"); // to avoid segmentation fault
+      rec_ts[counter] = timestamp;
+      if (rec_hw_ts && pkt_mbufs[i]->ol_flags & PKT_RX_TIMESTAMP)
+        rec_hw_ts[counter] = pkt_mbufs[i]->timestamp; // the timestamp of the NIC (see timestamp.h)
     }
+    if (p->validator)
+      p->validator->check(pkt_mbufs, pdv, counters);
+    if (p->ce_stats)
+      p->ce_stats->count(pkt_mbufs, pdv, queue_id);
+    freeBurst(pkt_mbufs, frames);
+    counters->received = received; // the counter is in the own cache line of the receiver
   }
-  if (frame_timeout == 0)
-    printf("%s frames received: %lu\n", direction, received); //  printed if normal PDV, but not printed if special throughput measurement is done
-  return received;
+  return 0;
 }
 
 // performs PDV measurement
 void Pdv::measure(uint16_t leftport, uint16_t rightport)
 {
   uint64_t *left_send_ts, *right_send_ts, *left_receive_ts, *right_receive_ts; // pointers for timestamp arrays
+  uint64_t *left_receive_hw_ts = NULL, *right_receive_hw_ts = NULL;             // pointers for hardware receive timestamp arrays (if used)
+  HwClock *left_clock = NULL, *right_clock = NULL;                             // the clocks of the ports (if hardware RX timestamps are used)
+  uint64_t received;                                                           // number of frames received in a direction
 
   // set common parameters for senders
   senderCommonParameters scp(ipv6_frame_size, ipv4_frame_size, frame_rate, test_duration, n, m, hz, start_tsc,
                              num_of_CEs, num_of_port_sets, num_of_ports,  &tester_left_ipv6, &tester_right_ipv4, &dmr_ipv6, &tester_right_ipv6,
-                             bg_sport_min, bg_sport_max, bg_dport_min, bg_dport_max
+                             bg_sport_min, bg_sport_max, bg_dport_min, bg_dport_max, tx_burst_size, tx_max_skew, frame_ring_mb,
+                             pacer_profile, pacer_burst, pacer_period, pacer_amplitude, false, 0
                              );
+  uint64_t num_frames = (uint64_t)test_duration * frame_rate; // the number of frames sent in a direction
+
+  // the parameters must exist until the senders and receivers finish
+  senderParametersPdv *left_spars[MAX_SENDERS], *right_spars[MAX_SENDERS]; // parameters of the senders
+  receiverParametersPdv *right_rpars[MAX_RECEIVERS], *left_rpars[MAX_RECEIVERS]; // parameters of the receivers
+
+  // the first calibration points of the clocks of the ports with hardware timestamps (see timestamp.h)
+  // Only RX timestamps are used, as the NIC can not latch the TX timestamp of every frame.
+  if (forward && right_hw_rx_ts)
+  {
+    right_clock = new HwClock(rightport, hz);
+    right_clock->calibrate();
+  }
+  if (reverse && left_hw_rx_ts)
+  {
+    left_clock = new HwClock(leftport, hz);
+    left_clock->calibrate();
+  }
 
   if (forward)
   { // Left to right direction is active
 
-    // set individual parameters for the left sender
-    // initialize the parameter class instance
-    senderParametersPdv spars(&scp, pkt_pool_left_sender, leftport, "forward", fwCE, (ether_addr *)dut_left_mac, (ether_addr *)tester_left_mac, fwd_var_sport, fwd_var_dport, fwd_dport_min, fwd_dport_max, &left_send_ts);
+    // prepare a cache line aligned array for the send timestamps of all the left senders (in the NUMA node of the first one)
+    left_send_ts = (uint64_t *)rte_malloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(left_sender_cpus[0]));
+    if (!left_send_ts)
+      rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
+
+    // set individual parameters for the left senders, and start them
+    for (int q = 0; q < num_left_senders; q++)
+    {
+      left_spars[q] = new senderParametersPdv(&scp, pkt_pool_left_sender[q], leftport, q, num_left_senders, "forward", &left_tx_counters[q], fwHotCE, fwOrder, (ether_addr *)dut_left_mac, (ether_addr *)tester_left_mac,
+                                              fwd_var_sport, fwd_var_dport, fwd_dport_min, fwd_dport_max, left_chksum_offload, left_frame_split, left_num_of_templates, left_send_ts);
+      if (rte_eal_remote_launch(sendPdv, left_spars[q], left_sender_cpus[q]))
+        std::cout << "Error: could not start Left Sender #" << q << "." << std::endl;
+    }
 
-    // start left sender
-    if (rte_eal_remote_launch(sendPdv, &spars, left_sender_cpu))
-      std::cout << "Error: could not start Left Sender." << std::endl;
+    // prepare a cache line aligned array for the receive timestamps of all the right receivers (in the NUMA node of the first one),
+    // and fill it with all 0-s (the frames are distributed among the receivers by RSS, but each frame is stored by a single receiver)
+    right_receive_ts = (uint64_t *)rte_zmalloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(right_receiver_cpus[0]));
+    if (!right_receive_ts)
+      rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
+    if (right_clock)
+    {
+      right_receive_hw_ts = (uint64_t *)rte_zmalloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(right_receiver_cpus[0]));
+      if (!right_receive_hw_ts)
+        rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
+    }
 
-    // set parameters for the right receiver
-    receiverParametersPdv rpars(finish_receiving, rightport, "forward", test_duration * frame_rate, frame_timeout, &right_receive_ts);
+    rte_eth_stats_reset(rightport); // the frames dropped by the receiving port are counted from here (see waitReceivers())
 
-    // start right receiver
-    if (rte_eal_remote_launch(receivePdv, &rpars, right_receiver_cpu))
-      std::cout << "Error: could not start Right Receiver." << std::endl;
+    // set individual parameters for the right receivers, and start them
+    for (int q = 0; q < num_right_receivers; q++)
+    {
+      right_rpars[q] = new receiverParametersPdv(finish_receiving, rightport, q, "forward", &right_rx_counters[q], fwValidator, fwCEStats, num_frames,
+                                                 right_receive_ts, right_receive_hw_ts);
+      if (rte_eal_remote_launch(receivePdv, right_rpars[q], right_receiver_cpus[q]))
+        std::cout << "Error: could not start Right Receiver #" << q << "." << std::endl;
+    }
   }
 
   if (reverse)
   { // Right to Left direction is active
     
-    // set individual parameters for the right sender
-    // initialize the parameter class instance
-    senderParametersPdv spars(&scp, pkt_pool_right_sender, rightport, "reverse", rvCE, (ether_addr *)dut_right_mac, (ether_addr *)tester_right_mac,
-                              rev_var_sport, rev_var_dport, rev_sport_min, rev_sport_max, &right_send_ts);
+    // prepare a cache line aligned array for the send timestamps of all the right senders (in the NUMA node of the first one)
+    right_send_ts = (uint64_t *)rte_malloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(right_sender_cpus[0]));
+    if (!right_send_ts)
+      rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
 
-    // start right sender
-    if (rte_eal_remote_launch(sendPdv, &spars, right_sender_cpu))
-      std::cout << "Error: could not start Right Sender." << std::endl;
+    // set individual parameters for the right senders, and start them
+    for (int q = 0; q < num_right_senders; q++)
+    {
+      right_spars[q] = new senderParametersPdv(&scp, pkt_pool_right_sender[q], rightport, q, num_right_senders, "reverse", &right_tx_counters[q], rvHotCE, rvOrder, (ether_addr *)dut_right_mac, (ether_addr *)tester_right_mac,
+                                               rev_var_sport, rev_var_dport, rev_sport_min, rev_sport_max, right_chksum_offload, right_frame_split, right_num_of_templates, right_send_ts);
+      if (rte_eal_remote_launch(sendPdv, right_spars[q], right_sender_cpus[q]))
+        std::cout << "Error: could not start Right Sender #" << q << "." << std::endl;
+    }
 
-    // set parameters for the left receiver
-    receiverParametersPdv rpars(finish_receiving, leftport, "reverse", test_duration * frame_rate, frame_timeout, &left_receive_ts);
+    // prepare a cache line aligned array for the receive timestamps of all the left receivers (in the NUMA node of the first one)
+    left_receive_ts = (uint64_t *)rte_zmalloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(left_receiver_cpus[0]));
+    if (!left_receive_ts)
+      rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
+    if (left_clock)
+    {
+      left_receive_hw_ts = (uint64_t *)rte_zmalloc_socket(0, 8 * num_frames, 128, rte_lcore_to_socket_id(left_receiver_cpus[0]));
+      if (!left_receive_hw_ts)
+        rte_exit(EXIT_FAILURE, "Error: Tester can't allocate memory for timestamps!\n");
+    }
+
+    rte_eth_stats_reset(leftport); // the frames dropped by the receiving port are counted from here (see waitReceivers())
 
-    // start left receiver
-    if (rte_eal_remote_launch(receivePdv, &rpars, left_receiver_cpu))
-      std::cout << "Error: could not start Left Receiver." << std::endl;
+    // set individual parameters for the left receivers, and start them
+    for (int q = 0; q < num_left_receivers; q++)
+    {
+      left_rpars[q] = new receiverParametersPdv(finish_receiving, leftport, q, "reverse", &left_rx_counters[q], rvValidator, rvCEStats, num_frames,
+                                                left_receive_ts, left_receive_hw_ts);
+      if (rte_eal_remote_launch(receivePdv, left_rpars[q], left_receiver_cpus[q]))
+        std::cout << "Error: could not start Left Receiver #" << q << "." << std::endl;
+    }
   }
 
   std::cout << "Info: Testing started." << std::endl;
+  if (monitor_interval)
+    runMonitor();
 
   // wait until active senders and receivers finish
   if (forward)
   {
-    rte_eal_wait_lcore(left_sender_cpu);
-    rte_eal_wait_lcore(right_receiver_cpu);
+    waitSenders((senderParameters **)left_spars, left_sender_cpus, num_left_senders, "forward");
+    received = waitReceivers((receiverParameters **)right_rpars, right_receiver_cpus, num_right_receivers);
+    if (frame_timeout == 0)
+      printf("forward frames received: %lu\n", received); //  printed if normal PDV, but not printed if special throughput measurement is done
+    for (int q = 0; q < num_left_senders; q++)
+      delete left_spars[q];
+    for (int q = 0; q < num_right_receivers; q++)
+      delete right_rpars[q];
   }
   if (reverse)
   {
-    rte_eal_wait_lcore(right_sender_cpu);
-    rte_eal_wait_lcore(left_receiver_cpu);
+    waitSenders((senderParameters **)right_spars, right_sender_cpus, num_right_senders, "reverse");
+    received = waitReceivers((receiverParameters **)left_rpars, left_receiver_cpus, num_left_receivers);
+    if (frame_timeout == 0)
+      printf("reverse frames received: %lu\n", received); //  printed if normal PDV, but not printed if special throughput measurement is done
+    for (int q = 0; q < num_right_senders; q++)
+      delete right_spars[q];
+    for (int q = 0; q < num_left_receivers; q++)
+      delete left_rpars[q];
+  }
+
+  // replace the software RX timestamps with the hardware ones, where possible (see timestamp.h)
+  if (right_clock)
+  {
+    right_clock->calibrate();
+    right_clock->convert(right_receive_ts, right_receive_hw_ts, num_frames, "RX", "forward");
+    rte_free(right_receive_hw_ts);
+    delete right_clock;
+  }
+  if (left_clock)
+  {
+    left_clock->calibrate();
+    left_clock->convert(left_receive_ts, left_receive_hw_ts, num_frames, "RX", "reverse");
+    rte_free(left_receive_hw_ts);
+    delete left_clock;
   }
 
   // Process the timestamps
   int penalty = 1000 * test_duration + stream_timeout; // latency to be reported for lost timestamps, expressed in milliseconds
 
   if (forward)
-    evaluatePdv(test_duration * frame_rate, left_send_ts, right_receive_ts, hz, frame_timeout, penalty, "forward");
+    evaluatePdv(num_frames, left_send_ts, right_receive_ts, hz, frame_timeout, penalty, "forward");
   if (reverse)
-    evaluatePdv(test_duration * frame_rate, right_send_ts, left_receive_ts, hz, frame_timeout, penalty, "reverse");
-
-  if (fwCE)
-    rte_free(fwCE); // release the CEs data memory at the forward sender
-  if (rvCE)
-    rte_free(rvCE); // release the CEs data memory at the reverse sender
-  if (fwUniqueEAComb) 
-    rte_free(fwUniqueEAComb);	// release the memory of the pre-generated unique EA-bits combinations at the forward sender
-  if (rvUniqueEAComb) 
-    rte_free(rvUniqueEAComb);	// release the memory of the pre-generated unique EA-bits combinations at the reverse sender
+    evaluatePdv(num_frames, right_send_ts, left_receive_ts, hz, frame_timeout, penalty, "reverse");
+
+  if (fwCEStats)
+  {
+    addCELatencies(fwCEStats, left_send_ts, right_receive_ts);
+    reportCEStats(fwCEStats, num_left_senders, left_frame_split, false, "forward");
+  }
+  if (rvCEStats)
+  {
+    addCELatencies(rvCEStats, right_send_ts, left_receive_ts);
+    reportCEStats(rvCEStats, num_right_senders, right_frame_split, false, "reverse");
+  }
+
+  release(); // release the CE arrays, and the tables of the validators and of the per-CE accounting
   std::cout << "Info: Test finished." << std::endl;
 }
 
 // sets the values of the data fields
-senderParametersPdv::senderParametersPdv(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, const char *direction_,
-                                         CE_data *CE_array_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
-                                         uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_,
-                                         uint64_t **send_ts_) : senderParameters(cp_, pkt_pool_, eth_id_, direction_,
-                                                                                 CE_array_, dst_mac_, src_mac_, var_sport_, var_dport_,
-                                                                                 preconfigured_port_min_, preconfigured_port_max_)
+senderParametersPdv::senderParametersPdv(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, uint16_t queue_id_, uint16_t num_of_queues_, const char *direction_,
+                                         struct txCounters *counters_, const void *hot_CEs_, const CEOrder *ce_order_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
+                                         uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_, bool chksum_offload_, bool frame_split_,
+                                         int num_of_templates_, uint64_t *send_ts_) : senderParameters(cp_, pkt_pool_, eth_id_, queue_id_, num_of_queues_, direction_,
+                                                                                 counters_, hot_CEs_, ce_order_, dst_mac_, src_mac_, var_sport_, var_dport_,
+                                                                                 preconfigured_port_min_, preconfigured_port_max_, chksum_offload_, frame_split_,
+                                                                                 num_of_templates_)
 {
   send_ts = send_ts_;
 }
 
 // sets the values of the data fields
-receiverParametersPdv::receiverParametersPdv(uint64_t finish_receiving_, uint8_t eth_id_, const char *direction_,
-                                             uint64_t num_frames_, uint16_t frame_timeout_, uint64_t **receive_ts_) : receiverParameters(finish_receiving_, eth_id_, direction_)
+receiverParametersPdv::receiverParametersPdv(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                                             Validator *validator_, CEStats *ce_stats_, uint64_t num_frames_, uint64_t *receive_ts_,
+                                             uint64_t *receive_hw_ts_) : receiverParameters(finish_receiving_, eth_id_, queue_id_,
+                                                                                                                                         direction_, counters_, validator_, ce_stats_, NULL, 0)
 {
   num_frames = num_frames_;
-  frame_timeout = frame_timeout_;
   receive_ts = receive_ts_;
+  receive_hw_ts = receive_hw_ts_;
+}
+
+// adds the delays of the foreground PDV Frames of a direction to the per-CE statistics (see cestats.h)
+// Every frame is a PDV Frame, and its CE is determined by its ordinal number, like in the sending cycle (see FrameGenerator::loop()).
+void Pdv::addCELatencies(CEStats *stats, uint64_t *send_ts, uint64_t *receive_ts)
+{
+  uint64_t num_frames = (uint64_t)test_duration * frame_rate; // see measure()
+  for (uint64_t i = 0; i < num_frames; i++)
+    if (i % n < m)
+      stats->addLatency(stats->frameCE(i), receive_ts[i] != 0, 1000.0 * (receive_ts[i] - send_ts[i]) / hz);
 }
 
 void evaluatePdv(uint64_t num_of_frames, uint64_t *send_ts, uint64_t *receive_ts, uint64_t hz, uint16_t frame_timeout, int penalty, const char *direction)
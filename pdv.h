@@ -29,6 +29,7 @@ public:
 
   Pdv() : Throughput(){};                        // default constructor
   int readCmdLine(int argc, const char *argv[]); // reads further one argument: frame_timeout
+  void addCELatencies(CEStats *stats, uint64_t *send_ts, uint64_t *receive_ts); // adds the delays of the PDV Frames to the per-CE statistics
 
   // perform pdv measurement
   void measure(uint16_t leftport, uint16_t rightport);
@@ -48,21 +49,21 @@ struct rte_mbuf *mkPdvFrame6(uint16_t length, rte_mempool *pkt_pool, const char
 class senderParametersPdv : public senderParameters
 {
 public:
-  uint64_t **send_ts;
-  senderParametersPdv(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, const char *direction_,
-                      CE_data *CE_array_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
-                      uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_,
-                      uint64_t **send_ts_);
+  uint64_t *send_ts; // pointer to the send timestamps (common for the senders of the direction)
+  senderParametersPdv(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, uint16_t queue_id_, uint16_t num_of_queues_, const char *direction_,
+                      struct txCounters *counters_, const void *hot_CEs_, const CEOrder *ce_order_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
+                      uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_, bool chksum_offload_, bool frame_split_,
+                      int num_of_templates_, uint64_t *send_ts_);
 };
 
 class receiverParametersPdv : public receiverParameters
 {
 public:
-  uint64_t num_frames; // number of all frames, needed for the rte_zmalloc call for allocating receive_ts
-  uint16_t frame_timeout;
-  uint64_t **receive_ts;
-  receiverParametersPdv(uint64_t finish_receiving_, uint8_t eth_id_, const char *direction_,
-                        uint64_t num_frames_, uint16_t frame_timeout_, uint64_t **receive_ts_);
+  uint64_t num_frames;  // number of all frames, needed for checking the frame IDs
+  uint64_t *receive_ts; // pointer to the receive timestamps (common for the receivers of the direction)
+  uint64_t *receive_hw_ts; // pointer to the hardware receive timestamps (common for the receivers of the direction, NULL if they are not used)
+  receiverParametersPdv(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                        Validator *validator_, CEStats *ce_stats_, uint64_t num_frames_, uint64_t *receive_ts_, uint64_t *receive_hw_ts_);
 };
 
 void evaluatePdv(uint64_t num_of_frames, uint64_t *send_ts, uint64_t *receive_ts, uint64_t hz, uint16_t frame_timeout, int penalty, const char *direction);
@@ -0,0 +1,106 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "randport.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// the 64-bit SplitMix generator is used for expanding the seed into the states of the generators
+static uint64_t splitMix64(uint64_t &x)
+{
+  uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+RandomPorts::RandomPorts()
+{
+  std::random_device rd; // Will be used to obtain a seed for the generators
+  uint64_t seed = ((uint64_t)rd() << 32) | rd();
+  for (int k = 0; k < RANDPORT_LANES; k++)
+    for (int j = 0; j < 4; j += 2)
+    {
+      uint64_t r = splitMix64(seed); // SplitMix64 never produces an all-zero state for the 4 words of a lane
+      state[j][k] = (uint32_t)r;
+      state[j + 1][k] = (uint32_t)(r >> 32);
+    }
+  pos = RANDPORT_BUFSIZE; // the buffer is filled at the first use
+}
+
+#ifdef __AVX2__
+// rotates the 32-bit lanes of x left by k bits
+#define ROTL_AVX2(x, k) _mm256_or_si256(_mm256_slli_epi32((x), (k)), _mm256_srli_epi32((x), 32 - (k)))
+
+void RandomPorts::refill()
+{
+  __m256i s0 = _mm256_load_si256((__m256i *)state[0]);
+  __m256i s1 = _mm256_load_si256((__m256i *)state[1]);
+  __m256i s2 = _mm256_load_si256((__m256i *)state[2]);
+  __m256i s3 = _mm256_load_si256((__m256i *)state[3]);
+  for (int i = 0; i < RANDPORT_BUFSIZE; i += RANDPORT_LANES)
+  {
+    // result = rotl(s1 * 5, 7) * 9, where the multiplications are done by shift and add
+    __m256i r = _mm256_add_epi32(_mm256_slli_epi32(s1, 2), s1);
+    r = ROTL_AVX2(r, 7);
+    r = _mm256_add_epi32(_mm256_slli_epi32(r, 3), r);
+    _mm256_store_si256((__m256i *)(buf + i), r);
+    __m256i t = _mm256_slli_epi32(s1, 9);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = ROTL_AVX2(s3, 11);
+  }
+  _mm256_store_si256((__m256i *)state[0], s0);
+  _mm256_store_si256((__m256i *)state[1], s1);
+  _mm256_store_si256((__m256i *)state[2], s2);
+  _mm256_store_si256((__m256i *)state[3], s3);
+  pos = 0;
+}
+#else
+// rotates x left by k bits
+static inline uint32_t rotl32(uint32_t x, int k)
+{
+  return (x << k) | (x >> (32 - k));
+}
+
+// the same lanes are computed as by the AVX2 version, thus the output does not depend on the CPU
+void RandomPorts::refill()
+{
+  for (int i = 0; i < RANDPORT_BUFSIZE; i += RANDPORT_LANES)
+    for (int k = 0; k < RANDPORT_LANES; k++)
+    {
+      uint32_t t = state[1][k] << 9;
+      buf[i + k] = rotl32(state[1][k] * 5, 7) * 9;
+      state[2][k] ^= state[0][k];
+      state[3][k] ^= state[1][k];
+      state[1][k] ^= state[2][k];
+      state[0][k] ^= state[3][k];
+      state[2][k] ^= t;
+      state[3][k] = rotl32(state[3][k], 11);
+    }
+  pos = 0;
+}
+#endif
@@ -0,0 +1,51 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RANDPORT_H_INCLUDED
+#define RANDPORT_H_INCLUDED
+
+#define RANDPORT_LANES 8     // number of independent xoshiro128** generators (one AVX2 register of 32-bit lanes)
+#define RANDPORT_BUFSIZE 256 // number of 32-bit random values produced by a single refill (must be a multiple of RANDPORT_LANES)
+
+// Fast pseudorandom port number generator for the RFC 4814 pseudorandom port mode of the senders
+// RANDPORT_LANES xoshiro128** generators are run in parallel (using AVX2 instructions, if the CPU has them),
+// and a buffer of 32-bit random values is filled at once. A port number is taken from the buffer by a multiply-shift
+// range reduction, which needs neither division nor a rejection loop (its bias is below 2^-16, negligible for testing).
+class RandomPorts
+{
+public:
+  RandomPorts(); // seeds the generators using std::random_device
+  inline uint16_t next(uint16_t min, uint16_t max); // returns a pseudorandom port number in [min, max]
+
+private:
+  void refill(); // fills the buffer with new random values
+  alignas(32) uint32_t state[4][RANDPORT_LANES]; // states of the generators: state[j][k] is word j of lane k
+  alignas(32) uint32_t buf[RANDPORT_BUFSIZE];    // buffer of random values
+  uint16_t pos;                                  // position of the next unused value in buf
+};
+
+inline uint16_t RandomPorts::next(uint16_t min, uint16_t max)
+{
+  if (pos == RANDPORT_BUFSIZE)
+    refill();
+  return min + (uint16_t)(((uint64_t)buf[pos++] * (uint32_t)(max - min + 1)) >> 32);
+}
+
+#endif
@@ -0,0 +1,102 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "pacer.h"
+#include "search.h"
+#include <unistd.h>
+
+// performs 'Search-experiments' binary searches in the [search_low, frame_rate] interval (see search.h)
+void Throughput::binarySearch(uint16_t leftport, uint16_t rightport)
+{
+  uint32_t max = frame_rate; // the upper bound given in the command line
+  uint32_t l, h, r = 0;      // the lower and upper bounds, and the rate of the current trial
+  int i = 0;                 // the number of the current trial of the search
+  bool first = true;         // the first trial uses the start time prepared by init()
+  char date[32];             // the date and time of the last trial of the search
+  time_t now;
+  FILE *f;
+
+  f = fopen(SEARCH_FILE, "w");
+  if (!f)
+    rte_exit(EXIT_FAILURE, "Error: can not open '%s' for writing!\n", SEARCH_FILE);
+  fprintf(f, "No, Size, Dir, n, m, Duration, Initial Rate, Timeout, Error, Date, Iterations needed, rate\n");
+  for (int N = 1; N <= search_experiments; N++)
+  {
+    l = search_low;
+    h = max;
+    date[0] = 0;
+    for (i = 1; h - l > search_error; i++)
+    {
+      r = (h + l) / 2;
+      printf("Testing rate: %u fps.\n", r);
+      if (!pacerTableSize(pacer_profile, pacer_burst, pacer_period, r))
+        rte_exit(EXIT_FAILURE, "Error: 'Pacer-period' must contain between 2 and %d frames at the rate of the trial!\n", PACER_MAX_TABLE);
+      frame_rate = r;
+      trial = trial == 65535 ? 1 : trial + 1; // 0 means no search
+      if (!first)
+      {
+        start_tsc = rte_rdtsc() + hz * TRIAL_START_DELAY / 1000;
+        finish_receiving = start_tsc + hz * (test_duration + stream_timeout / 1000.0);
+      }
+      first = false;
+      measure(leftport, rightport);
+
+      uint64_t required = (uint64_t)test_duration * r; // the number of frames to be sent in each active direction
+      uint64_t tolerated = (uint64_t)(required * (100 - search_loss) / 100);
+      bool passed = true;
+      if (forward)
+      {
+        printf("Forward: %lu frames were received from the required %lu frames\n", fw_received, required);
+        passed = passed && fw_received >= tolerated;
+      }
+      if (reverse)
+      {
+        printf("Reverse: %lu frames were received from the required %lu frames\n", rv_received, required);
+        passed = passed && rv_received >= tolerated;
+      }
+      if (passed)
+      {
+        l = r;
+        printf("TEST PASSED\n");
+      }
+      else
+      {
+        h = r;
+        printf("TEST FAILED\n");
+      }
+      printf("New diff: %u\n", h - l);
+      now = time(NULL);
+      strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+      printf("Sleeping for %d seconds...\n", search_sleep);
+      fflush(stdout);
+      sleep(search_sleep); // gives the DUT a chance to relax
+    }
+    // the number and the rate of the last trial, like in Throughput.sh
+    fprintf(f, "%d, %u, %s, %u, %u, %u, %u, %u, %u, %s, %d, %u\n", N, ipv6_frame_size, forward ? (reverse ? "b" : "f") : "r",
+            n, m, test_duration, max / 2, stream_timeout, search_error, date, i - 1, r);
+    fflush(f);
+  }
+  fclose(f);
+  frame_rate = max;
+  release();
+}
@@ -0,0 +1,43 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SEARCH_H_INCLUDED
+#define SEARCH_H_INCLUDED
+
+// In-process binary search for the throughput (optional, maptperf-tp only, see 'Search' in the configuration file)
+//
+// Instead of starting the Tester for each step of the binary search (see Throughput.sh), the steps (trials) are performed
+// by the same process: DPDK, the ports, the packet pools and the CE arrays are initialized only once. The command line
+// parameters are the same as those of a single test, and the frame rate given there is the upper bound of the search.
+// A trial passes, if each active direction received at least (100-Search-loss)% of the frames to be sent (with the
+// default 0 loss, all of them, like in Throughput.sh), then its rate becomes the lower bound, otherwise the upper one.
+// The results of the 'Search-experiments' searches are written into SEARCH_FILE in the format of Throughput.sh.
+//
+// The late frames of a failed trial may still be in flight (e.g. in the buffers of the DUT) when the next trial starts,
+// thus each trial has its own ID (1, 2, ..., 65535, 1, ...), which is written into the Test Frames after the sequence
+// number (at UDP Data + 16, still inside the 84-byte and 64-byte minimum frames), and the receivers ignore the frames
+// carrying another ID (see filterTrial() in classifier.h). The senders of a trial create new template frames; as the
+// NIC may still own those of the previous trial, the sender packet pools contain two generations of them.
+// The first trial starts START_DELAY, the further ones TRIAL_START_DELAY milliseconds after their preparation.
+
+#define SEARCH_FILE "rate.csv" // the results of the binary searches
+
+#endif
@@ -0,0 +1,134 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "classifier.h"
+#include "sequence.h"
+
+// allocates the windows of the streams of a receiver in the memory of its NUMA node
+SeqTracker::SeqTracker(uint64_t frames_to_send_, int num_of_senders_, int socket_id, const char *direction)
+{
+  frames_to_send = frames_to_send_;
+  num_of_senders = num_of_senders_;
+  memset(&res, 0, sizeof(res));
+  streams = (SeqStream *)rte_zmalloc_socket("sequence streams", num_of_senders * sizeof(SeqStream), RTE_CACHE_LINE_SIZE, socket_id);
+  windows = (uint64_t *)rte_zmalloc_socket("sequence windows", num_of_senders * (SEQ_WINDOW / 8), RTE_CACHE_LINE_SIZE, socket_id);
+  if (!streams || !windows)
+    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the sequence number windows of a %s receiver!\n", direction);
+  for (int q = 0; q < num_of_senders; q++)
+    streams[q].window = windows + q * (SEQ_WINDOW / 64);
+}
+
+SeqTracker::~SeqTracker()
+{
+  rte_free(streams);
+  rte_free(windows);
+}
+
+// moves the window of a stream so that its next expected position becomes new_next, and retires the positions leaving it
+// The positions between the old and the new next expected position were not received (they were never in the window).
+void SeqTracker::retire(SeqStream *s, uint64_t new_next)
+{
+  uint64_t lo = s->next > SEQ_WINDOW ? s->next - SEQ_WINDOW : 0; // the positions [lo, hi) leave the window
+  uint64_t hi = new_next > SEQ_WINDOW ? new_next - SEQ_WINDOW : 0;
+  uint64_t p, in_window = hi < s->next ? hi : s->next;
+  for (p = lo; p < in_window; p++)
+  {
+    uint64_t *word = &s->window[p / 64 % (SEQ_WINDOW / 64)];
+    uint64_t bit = 1ULL << (p % 64);
+    if (*word & bit)
+    {
+      *word &= ~bit;
+      endEpisode(s);
+    }
+    else
+      s->run++;
+  }
+  if (hi > in_window)
+    s->run += hi - (lo > in_window ? lo : in_window);
+}
+
+// records the current loss episode of a stream in the results
+void SeqTracker::recordEpisode(SeqStream *s)
+{
+  res.episodes++;
+  res.lost += s->run;
+  if (s->run > res.max_episode)
+    res.max_episode = s->run;
+  res.histogram[63 - __builtin_clzll(s->run)]++;
+  s->run = 0;
+}
+
+// retires all the positions of the streams after the test: the frames not received by now are lost
+void SeqTracker::finish()
+{
+  for (int q = 0; q < num_of_senders; q++)
+  {
+    uint64_t own_frames = (frames_to_send + num_of_senders - 1 - q) / num_of_senders; // see send()
+    retire(&streams[q], (own_frames > streams[q].next ? own_frames : streams[q].next) + SEQ_WINDOW);
+    endEpisode(&streams[q]);
+  }
+}
+
+// adds the results of the receiver to the sums of the direction
+void SeqTracker::addResults(SeqResults *sum)
+{
+  sum->reordered += res.reordered;
+  if (res.max_extent > sum->max_extent)
+    sum->max_extent = res.max_extent;
+  sum->duplicates += res.duplicates;
+  sum->late += res.late;
+  sum->invalid += res.invalid;
+  sum->episodes += res.episodes;
+  sum->lost += res.lost;
+  if (res.max_episode > sum->max_episode)
+    sum->max_episode = res.max_episode;
+  for (int b = 0; b < SEQ_BUCKETS; b++)
+    sum->histogram[b] += res.histogram[b];
+}
+
+// finishes the trackers of the receivers of a direction, and reports their results together
+void reportSeqResults(SeqTracker **trackers, int num_of_receivers, const char *direction)
+{
+  SeqResults sum;
+  memset(&sum, 0, sizeof(sum));
+  for (int q = 0; q < num_of_receivers; q++)
+  {
+    trackers[q]->finish();
+    trackers[q]->addResults(&sum);
+  }
+  printf("Info: %s sequence: reordered: %lu, maximum reordering extent: %lu, duplicates: %lu, late: %lu\n",
+         direction, sum.reordered, sum.max_extent, sum.duplicates, sum.late);
+  if (sum.invalid)
+    printf("Warning: %s frames with invalid sequence numbers: %lu\n", direction, sum.invalid);
+  if (num_of_receivers > 1)
+  {
+    printf("Info: %s reordering was detected only among the frames of the same receiver, as the frames were distributed among %d receivers\n",
+           direction, num_of_receivers);
+    printf("Info: %s loss episodes are not reported, as the frames were distributed among %d receivers\n", direction, num_of_receivers);
+    return;
+  }
+  printf("Info: %s loss episodes: %lu, lost frames: %lu, longest episode: %lu\n", direction, sum.episodes, sum.lost, sum.max_episode);
+  for (int b = 0; b < SEQ_BUCKETS; b++)
+    if (sum.histogram[b])
+      printf("Info: %s loss episodes of length %lu-%lu: %lu\n", direction, (uint64_t)1 << b, ((uint64_t)2 << b) - 1, sum.histogram[b]);
+}
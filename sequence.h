@@ -0,0 +1,164 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQUENCE_H_INCLUDED
+#define SEQUENCE_H_INCLUDED
+
+// Sequence number analysis of the received Test Frames (optional, maptperf-tp only, see 'Sequence' in the configuration file)
+//
+// The senders write the ordinal number of each frame (sent_frames) into the 8 bytes after the identifier, like the
+// serial number of the PDV Frames. As sender k sends the frames k, k+S, k+2*S, ... (see generator.h), the frames of
+// different senders are interleaved only by the Tester itself, thus each sender is a separate stream: the frame with
+// ordinal number seq is the (seq/S)-th frame of the stream of sender seq%S, and only the order within a stream is evaluated.
+//
+// A receiver tracks each stream by a sliding window of SEQ_WINDOW bits, whose upper end is the next expected position
+// (one above the highest one received so far), so the memory needed is independent of the number of frames:
+//   - a frame below the next expected position is reordered (RFC 4737), its reordering extent is the distance
+//     from the highest received position; if its bit is already set, it is a duplicate instead
+//   - the positions leaving the window are retired: the consecutive ones not received form a loss episode (RFC 3357),
+//     whose length is recorded in a histogram of power of 2 buckets
+//   - a frame arriving after its position left the window is counted as late (and it remains counted as lost)
+// If the frames of a direction are distributed among several receivers (by RSS), each of them sees only a part of each
+// stream, thus the loss episodes are meaningful only with a single receiver. The reordering is detected only among the
+// frames received by the same receiver: frames swapped between two receivers are not reported as reordered. The duplicates
+// are not affected, as the copies of a frame have the same headers, thus RSS delivers them to the same receiver.
+
+#define SEQ_WINDOW 65536 // the size of the window of a stream (frames, must be a power of 2)
+#define SEQ_BUCKETS 64   // the number of buckets of the loss episode length histogram: bucket b counts lengths [2^b, 2^(b+1))
+
+// the state of a stream
+struct SeqStream
+{
+  uint64_t next;    // the next expected position (one above the highest position received so far)
+  uint64_t run;     // the length of the current loss episode
+  uint64_t *window; // SEQ_WINDOW bits: the received positions of [next-SEQ_WINDOW, next), indexed by position % SEQ_WINDOW
+};
+
+// the results of a receiver, summed up by addResults()
+struct SeqResults
+{
+  uint64_t reordered;  // number of frames arriving below the next expected position (late frames included)
+  uint64_t max_extent; // the maximum reordering extent (in frames of the stream)
+  uint64_t duplicates; // number of frames received more than once
+  uint64_t late;       // number of frames arriving after their position left the window
+  uint64_t invalid;    // number of frames with a sequence number larger than any sent frame
+  uint64_t episodes;   // number of loss episodes
+  uint64_t lost;       // number of lost frames (the sum of the lengths of the loss episodes)
+  uint64_t max_episode; // the length of the longest loss episode
+  uint64_t histogram[SEQ_BUCKETS]; // the number of loss episodes by their lengths
+};
+
+class SeqTracker
+{
+public:
+  SeqTracker(uint64_t frames_to_send_, int num_of_senders_, int socket_id, const char *direction);
+  ~SeqTracker();
+
+  // tracks the sequence numbers of the Test Frames of a burst, whose bit masks are given by classifyBurst() (see classifier.h)
+  // Offsets of the sequence number from the start of the Ethernet Frame: IPv6: 14+40+8+8=70, IPv4: 14+20+8+8=50
+  inline void track(struct rte_mbuf **pkt_mbufs, RxMasks test)
+  {
+    uint32_t frames = test.ipv6 | test.ipv4;
+    for (; frames; frames &= frames - 1)
+    {
+      int i = __builtin_ctz(frames);
+      const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], const uint8_t *);
+      add(*(const uint64_t *)&pkt[test.ipv6 & (1u << i) ? 70 : 50]);
+    }
+  }
+
+  void finish(); // retires the rest of the streams after the test
+  void addResults(SeqResults *sum);
+
+private:
+  inline void add(uint64_t seq)
+  {
+    if (unlikely(seq >= frames_to_send))
+    {
+      res.invalid++;
+      return;
+    }
+    SeqStream *s = &streams[seq % num_of_senders];
+    uint64_t pos = seq / num_of_senders;
+    uint64_t *word = &s->window[pos / 64 % (SEQ_WINDOW / 64)];
+    uint64_t bit = 1ULL << (pos % 64);
+    if (likely(pos == s->next))
+    {
+      // the next expected frame: its position takes the bit of the position leaving the window
+      if (pos >= SEQ_WINDOW)
+      {
+        if (*word & bit)
+          endEpisode(s);
+        else
+          s->run++;
+      }
+      *word |= bit;
+      s->next = pos + 1;
+    }
+    else if (pos > s->next)
+    {
+      retire(s, pos + 1); // the frames of the gap are missing (yet)
+      *word |= bit;
+      s->next = pos + 1;
+    }
+    else if (pos + SEQ_WINDOW >= s->next)
+    {
+      if (*word & bit)
+        res.duplicates++;
+      else
+      {
+        *word |= bit;
+        reorder(s, pos);
+      }
+    }
+    else
+    {
+      res.late++;
+      reorder(s, pos);
+    }
+  }
+
+  inline void reorder(SeqStream *s, uint64_t pos)
+  {
+    res.reordered++;
+    if (s->next - 1 - pos > res.max_extent)
+      res.max_extent = s->next - 1 - pos;
+  }
+
+  // closes the current loss episode of a stream (if any)
+  inline void endEpisode(SeqStream *s)
+  {
+    if (unlikely(s->run))
+      recordEpisode(s);
+  }
+
+  void retire(SeqStream *s, uint64_t new_next);
+  void recordEpisode(SeqStream *s);
+
+  uint64_t frames_to_send; // the number of frames sent in the direction
+  int num_of_senders;      // the number of senders (streams) of the direction
+  SeqStream *streams;      // the states of the streams
+  uint64_t *windows;       // the memory of the windows of the streams
+  SeqResults res;          // the results of the receiver
+};
+
+void reportSeqResults(SeqTracker **trackers, int num_of_receivers, const char *direction);
+
+#endif
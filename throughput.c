@@ -21,8 +21,21 @@
 #include "defines.h"
 #include "includes.h"
 #include "throughput.h"
-
-char coresList[101];  // buffer for preparing the list of lcores for DPDK init (like a command line argument)
+#include "randport.h"
+#include "pacer.h"
+#include "generator.h"
+#include "classifier.h"
+#include "eatable.h"
+#include "validator.h"
+#include "ceorder.h"
+#include "cestats.h"
+#include "sequence.h"
+#include "monitor.h"
+#include "cecache.h"
+#include "eaperm.h"
+#include "mapaddr.h"
+
+std::string coresList; // for preparing the list of lcores for DPDK init (like a command line argument)
 char numChannels[11]; // buffer for printing the number of memory channels into a string for DPDK init (like a command line argument)
 
 Throughput::Throughput()
@@ -31,10 +44,10 @@ Throughput::Throughput()
   forward = 1;                   // default value, forward direction is active
   reverse = 1;                   // default value, reverse direction is active
   promisc = 0;                   // default value, promiscuous mode is inactive
-  left_sender_cpu = -1;          // MUST be set in the config file if forward != 0
-  right_receiver_cpu = -1;       // MUST be set in the config file if forward != 0
-  right_sender_cpu = -1;         // MUST be set in the config file if reverse != 0
-  left_receiver_cpu = -1;        // MUST be set in the config file if reverse != 0
+  num_left_senders = 0;          // MUST be set in the config file if forward != 0
+  num_right_receivers = 0;       // MUST be set in the config file if forward != 0
+  num_right_senders = 0;         // MUST be set in the config file if reverse != 0
+  num_left_receivers = 0;        // MUST be set in the config file if reverse != 0
   memory_channels = 1;           // default value, this value will be set, if not specified in the config file
   fwd_var_sport = 3;             // default value: use pseudorandom change for the source port numbers in the forward direction
   fwd_var_dport = 3;             // default value: use pseudorandom change for the destination port numbers in the forward direction
@@ -48,6 +61,34 @@ Throughput::Throughput()
   bg_sport_max = 65535;          // default value: as recommended by RFC 4814
   bg_dport_min = 1;              // default value: as recommended by RFC 4814
   bg_dport_max = 49151;          // default value: as recommended by RFC 4814
+  tx_burst_size = 1;             // default value: precision mode, every frame is sent individually at its own time
+  tx_max_skew = 10;              // default value: the last frame of a burst may be sent at most 10 microseconds earlier than due
+  frame_ring_mb = 0;             // default value: no pre-rendered frames, the fields of the frames are updated in the sending cycle
+  tx_chksum_offload = 0;         // default value: checksums are calculated by the senders
+  frame_split = 0;               // default value: every frame is a single segment containing also the payload
+  pacer_profile = PACER_CBR;     // default value: constant bit rate
+  pacer_burst = 32;              // default value: microbursts of 32 frames (used by the on/off profile only)
+  pacer_period = 1000;           // default value: 1 second period (used by the sinusoidal profile only)
+  pacer_amplitude = 50;          // default value: the frame rate varies between 50% and 150% (used by the sinusoidal profile only)
+  validate = 0;                  // default value: the received Test Frames are only counted
+  ce_stats = 0;                  // default value: no per-CE accounting
+  sequence = 0;                  // default value: no sequence numbers
+  hw_timestamp = 0;              // default value: software timestamps
+  latency_histogram = 0;         // default value: RFC 8219 latency measurement with tagged frames
+  monitor_interval = 0;          // default value: no live traffic monitor
+  search = 0;                    // default value: one test with the given frame rate
+  search_low = 0;                // default values of the binary search are those of Throughput.sh
+  search_error = 1;
+  search_experiments = 10;
+  search_loss = 0;
+  search_sleep = 10;
+  ce_seed = 0;                   // default value: random seed, a new permutation of the EA-bits combinations in each run
+  ce_cache[0] = 0;               // default value: no cache of the CE arrays
+  ce_order = CE_ORDER_SEQUENTIAL; // default value: the CEs are visited in a fixed cyclic order
+  ce_skew = 1.0;
+  ce_hot_ces = 10;
+  ce_hot_load = 90;
+  trial = 0;
   
   bmr_ipv6_prefix = {{0x20, 0x01, 0x0d, 0xb8, 0x00, 0xce, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}; // 2001:db8:ce::
   bmr_ipv6_prefix_length = 51;   // /51
@@ -59,10 +100,16 @@ Throughput::Throughput()
 
   // some other variables
   dmr_ipv6 = IN6ADDR_ANY_INIT;  
-  fwUniqueEAComb = NULL;         
-  rvUniqueEAComb = NULL;                                    
   fwCE = NULL;                  
   rvCE = NULL;                  
+  fwHotCE = NULL;
+  rvHotCE = NULL;
+  fwOrder = NULL;
+  rvOrder = NULL;
+  fwValidator = NULL;
+  rvValidator = NULL;
+  fwCEStats = NULL;
+  rvCEStats = NULL;
 };
 
 // finds a 'key' (name of a parameter) in the 'line' string
@@ -87,6 +134,39 @@ int Throughput::findKey(const char *line, const char *key)
   return -1;
 }
 
+// reads a comma separated list of at most 'max_cpus' lcores (e.g. "2,4,6") into the 'cpus' array, 'key' is used in the error messages
+// return: the number of lcores read, if the list is valid; -1 otherwise
+int Throughput::readCpuList(const char *line, int *cpus, int max_cpus, const char *key)
+{
+  int num_cpus = 0; // the number of lcores read so far
+  int len;          // the number of characters consumed by sscanf
+
+  do
+  {
+    if (num_cpus == max_cpus)
+    {
+      std::cerr << "Input Error: '" << key << "' may contain at most " << max_cpus << " lcores." << std::endl;
+      return -1;
+    }
+    if (sscanf(line, " %d%n", &cpus[num_cpus], &len) != 1 || cpus[num_cpus] < 0 || cpus[num_cpus] >= RTE_MAX_LCORE)
+    {
+      std::cerr << "Input Error: '" << key << "' must be a comma separated list of lcores, each of them >= 0 and < RTE_MAX_LCORE." << std::endl;
+      return -1;
+    }
+    for (int i = 0; i < num_cpus; i++)
+      if (cpus[i] == cpus[num_cpus])
+      {
+        std::cerr << "Input Error: '" << key << "' contains lcore " << cpus[i] << " more than once." << std::endl;
+        return -1;
+      }
+    num_cpus++;
+    line += len;
+    while (*line == ' ' || *line == '\t')
+      line++;
+  } while (*line++ == ',');
+  return num_cpus;
+}
+
 // skips leading spaces and tabs, and cuts off tail starting by a space, tab or new line character
 // it is needed, because inet_pton cannot read if there is e.g. a trailing '\n'
 // WARNING: the input buffer is changed!
@@ -306,12 +386,14 @@ int Throughput::readConfigFile(const char *filename)
     }
     else if ((pos = findKey(line, "NUM-OF-CEs")) >= 0)
     {
-      sscanf(line + pos, "%u", &num_of_CEs);
-      if (num_of_CEs < 1 || num_of_CEs > 1000000)
+      uint64_t num = 0; // read as a 64-bit number, thus too large values are not truncated
+      sscanf(line + pos, "%lu", &num);
+      if (num < 1 || num > MAX_NUM_OF_CES)
       {
-        std::cerr << "Input Error: 'NUM-OF-CEs' must be >= 1 and <= 1000000." << std::endl;
+        std::cerr << "Input Error: 'NUM-OF-CEs' must be >= 1 and <= " << MAX_NUM_OF_CES << "." << std::endl;
         return -1;
       }
+      num_of_CEs = (uint32_t)num;
     }
     else if ((pos = findKey(line, "BMR-IPv6-Prefix")) >= 0)
     {
@@ -375,39 +457,23 @@ int Throughput::readConfigFile(const char *filename)
     }
     else if ((pos = findKey(line, "CPU-FW-Send")) >= 0)
     {
-      sscanf(line + pos, "%d", &left_sender_cpu);
-      if (left_sender_cpu < 0 || left_sender_cpu >= RTE_MAX_LCORE)
-      {
-        std::cerr << "Input Error: 'CPU-FW-Send' must be >= 0 and < RTE_MAX_LCORE." << std::endl;
+      if ((num_left_senders = readCpuList(line + pos, left_sender_cpus, MAX_SENDERS, "CPU-FW-Send")) < 0)
         return -1;
-      }
     }
     else if ((pos = findKey(line, "CPU-FW-Receive")) >= 0)
     {
-      sscanf(line + pos, "%d", &right_receiver_cpu);
-      if (right_receiver_cpu < 0 || right_receiver_cpu >= RTE_MAX_LCORE)
-      {
-        std::cerr << "Input Error: 'CPU-FW-Receive' must be >= 0 and < RTE_MAX_LCORE." << std::endl;
+      if ((num_right_receivers = readCpuList(line + pos, right_receiver_cpus, MAX_RECEIVERS, "CPU-FW-Receive")) < 0)
         return -1;
-      }
     }
     else if ((pos = findKey(line, "CPU-RV-Send")) >= 0)
     {
-      sscanf(line + pos, "%d", &right_sender_cpu);
-      if (right_sender_cpu < 0 || right_sender_cpu >= RTE_MAX_LCORE)
-      {
-        std::cerr << "Input Error: 'CPU-RV-Send' must be >= 0 and < RTE_MAX_LCORE." << std::endl;
+      if ((num_right_senders = readCpuList(line + pos, right_sender_cpus, MAX_SENDERS, "CPU-RV-Send")) < 0)
         return -1;
-      }
     }
     else if ((pos = findKey(line, "CPU-RV-Receive")) >= 0)
     {
-      sscanf(line + pos, "%d", &left_receiver_cpu);
-      if (left_receiver_cpu < 0 || left_receiver_cpu >= RTE_MAX_LCORE)
-      {
-        std::cerr << "Input Error: 'CPU-RV-Receive' must be >= 0 and < RTE_MAX_LCORE." << std::endl;
+      if ((num_left_receivers = readCpuList(line + pos, left_receiver_cpus, MAX_RECEIVERS, "CPU-RV-Receive")) < 0)
         return -1;
-      }
     }
     else if ((pos = findKey(line, "Mem-Channels")) >= 0)
     {
@@ -436,6 +502,232 @@ int Throughput::readConfigFile(const char *filename)
         return -1;
       }
     }
+    else if ((pos = findKey(line, "TX-burst-size")) >= 0)
+    {
+      sscanf(line + pos, "%hu", &tx_burst_size);
+      if (tx_burst_size < 1 || tx_burst_size > MAX_PKT_BURST)
+      {
+        std::cerr << "Input Error: 'TX-burst-size' must be >= 1 and <= " << MAX_PKT_BURST << "." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "TX-max-skew")) >= 0)
+    {
+      if (sscanf(line + pos, "%hu", &tx_max_skew) < 1)
+      {
+        std::cerr << "Input Error: Unable to read 'TX-max-skew'." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Frame-ring-MB")) >= 0)
+    {
+      if (sscanf(line + pos, "%u", &frame_ring_mb) < 1)
+      {
+        std::cerr << "Input Error: Unable to read 'Frame-ring-MB'." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "TX-chksum-offload")) >= 0)
+    {
+      sscanf(line + pos, "%d", &tx_chksum_offload);
+      if (!(tx_chksum_offload == 0 || tx_chksum_offload == 1))
+      {
+        std::cerr << "Input Error: 'TX-chksum-offload' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Frame-split")) >= 0)
+    {
+      sscanf(line + pos, "%d", &frame_split);
+      if (!(frame_split == 0 || frame_split == 1))
+      {
+        std::cerr << "Input Error: 'Frame-split' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Pacer-profile")) >= 0)
+    {
+      sscanf(line + pos, "%d", &pacer_profile);
+      if (pacer_profile < PACER_CBR || pacer_profile > PACER_SINE)
+      {
+        std::cerr << "Input Error: 'Pacer-profile' must be 0 for CBR, 1 for Poisson, 2 for on/off microbursts or 3 for sinusoidal." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Pacer-burst")) >= 0)
+    {
+      sscanf(line + pos, "%hu", &pacer_burst);
+      if (pacer_burst < 1)
+      {
+        std::cerr << "Input Error: 'Pacer-burst' must be at least 1." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Pacer-period")) >= 0)
+    {
+      sscanf(line + pos, "%hu", &pacer_period);
+      if (pacer_period < 1)
+      {
+        std::cerr << "Input Error: 'Pacer-period' must be at least 1." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Pacer-amplitude")) >= 0)
+    {
+      sscanf(line + pos, "%hu", &pacer_amplitude);
+      if (pacer_amplitude > 99)
+      {
+        std::cerr << "Input Error: 'Pacer-amplitude' must be between 0 and 99." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Validate")) >= 0)
+    {
+      sscanf(line + pos, "%d", &validate);
+      if (!(validate == 0 || validate == 1))
+      {
+        std::cerr << "Input Error: 'Validate' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "CE-stats")) >= 0)
+    {
+      sscanf(line + pos, "%d", &ce_stats);
+      if (!(ce_stats == 0 || ce_stats == 1))
+      {
+        std::cerr << "Input Error: 'CE-stats' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Sequence")) >= 0)
+    {
+      sscanf(line + pos, "%d", &sequence);
+      if (!(sequence == 0 || sequence == 1))
+      {
+        std::cerr << "Input Error: 'Sequence' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "HW-timestamp")) >= 0)
+    {
+      sscanf(line + pos, "%d", &hw_timestamp);
+      if (!(hw_timestamp == 0 || hw_timestamp == 1))
+      {
+        std::cerr << "Input Error: 'HW-timestamp' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Latency-histogram")) >= 0)
+    {
+      sscanf(line + pos, "%d", &latency_histogram);
+      if (!(latency_histogram == 0 || latency_histogram == 1))
+      {
+        std::cerr << "Input Error: 'Latency-histogram' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Monitor-interval")) >= 0)
+    {
+      sscanf(line + pos, "%u", &monitor_interval);
+      if (monitor_interval > 60000)
+      {
+        std::cerr << "Input Error: 'Monitor-interval' must be between 1 and 60000 milliseconds (or 0 for inactive)." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Search-low")) >= 0)
+    {
+      sscanf(line + pos, "%u", &search_low);
+    }
+    else if ((pos = findKey(line, "Search-error")) >= 0)
+    {
+      sscanf(line + pos, "%u", &search_error);
+      if (search_error < 1)
+      {
+        std::cerr << "Input Error: 'Search-error' must be at least 1." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Search-experiments")) >= 0)
+    {
+      sscanf(line + pos, "%d", &search_experiments);
+      if (search_experiments < 1)
+      {
+        std::cerr << "Input Error: 'Search-experiments' must be at least 1." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Search-loss")) >= 0)
+    {
+      sscanf(line + pos, "%lf", &search_loss);
+      if (search_loss < 0 || search_loss >= 100)
+      {
+        std::cerr << "Input Error: 'Search-loss' must be at least 0 and less than 100 (percent)." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Search-sleep")) >= 0)
+    {
+      sscanf(line + pos, "%d", &search_sleep);
+      if (search_sleep < 0 || search_sleep > 3600)
+      {
+        std::cerr << "Input Error: 'Search-sleep' must be between 0 and 3600." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "Search")) >= 0) // after the other keys starting with "Search"
+    {
+      sscanf(line + pos, "%d", &search);
+      if (!(search == 0 || search == 1))
+      {
+        std::cerr << "Input Error: 'Search' must be either 0 for inactive or 1 for active." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "CE-seed")) >= 0)
+    {
+      if (sscanf(line + pos, "%lu", &ce_seed) < 1)
+      {
+        std::cerr << "Input Error: Unable to read 'CE-seed'." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "CE-cache")) >= 0)
+    {
+      char *dir = prune(line + pos);
+      if (!*dir)
+      {
+        std::cerr << "Input Error: 'CE-cache' must be either 0 for inactive or the directory of the cache files." << std::endl;
+        return -1;
+      }
+      strcpy(ce_cache, strcmp(dir, "0") ? dir : "");
+    }
+    else if ((pos = findKey(line, "CE-order")) >= 0)
+    {
+      sscanf(line + pos, "%d", &ce_order);
+      if (ce_order < CE_ORDER_SEQUENTIAL || ce_order > CE_ORDER_HOTSET)
+      {
+        std::cerr << "Input Error: 'CE-order' must be 0 for sequential, 1 for shuffled, 2 for random, 3 for Zipf or 4 for hot set." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "CE-skew")) >= 0)
+    {
+      sscanf(line + pos, "%lf", &ce_skew);
+      if (ce_skew <= 0 || ce_skew > 10)
+      {
+        std::cerr << "Input Error: 'CE-skew' must be more than 0 and at most 10." << std::endl;
+        return -1;
+      }
+    }
+    else if ((pos = findKey(line, "CE-hot-set")) >= 0)
+    {
+      if (sscanf(line + pos, "%lf %lf", &ce_hot_ces, &ce_hot_load) < 2 || ce_hot_ces <= 0 || ce_hot_ces > 100 || ce_hot_load < 0 || ce_hot_load > 100)
+      {
+        std::cerr << "Input Error: 'CE-hot-set' must be two percents: that of the CEs (more than 0) and that of the frames." << std::endl;
+        return -1;
+      }
+    }
     else if ((pos = findKey(line, "Promisc")) >= 0)
     {
       sscanf(line + pos, "%d", &promisc);
@@ -462,12 +754,12 @@ int Throughput::readConfigFile(const char *filename)
   // check if the necessary lcores were specified
   if (forward)
   {
-    if (left_sender_cpu < 0)
+    if (num_left_senders == 0)
     {
       std::cerr << "Input Error: No 'CPU-FW-Send' was specified." << std::endl;
       return -1;
     }
-    if (right_receiver_cpu < 0)
+    if (num_right_receivers == 0)
     {
       std::cerr << "Input Error: No 'CPU-FW-Receive' was specified." << std::endl;
       return -1;
@@ -475,17 +767,41 @@ int Throughput::readConfigFile(const char *filename)
   }
   if (reverse)
   {
-    if (right_sender_cpu < 0)
+    if (num_right_senders == 0)
     {
       std::cerr << "Input Error: No 'CPU-RV-Send' was specified." << std::endl;
       return -1;
     }
-    if (left_receiver_cpu < 0)
+    if (num_left_receivers == 0)
     {
       std::cerr << "Input Error: No 'CPU-RV-Receive' was specified." << std::endl;
       return -1;
     }
   }
+  // the replayed frames of the frame ring would repeat the same sequence numbers
+  if (sequence && frame_ring_mb)
+  {
+    std::cerr << "Input Error: 'Sequence' can not be used together with 'Frame-ring-MB'." << std::endl;
+    return -1;
+  }
+  // the pools of the frame rings are not reused by the trials, and the per-CE counters are not reset (see search.h)
+  if (search && (frame_ring_mb || ce_stats))
+  {
+    std::cerr << "Input Error: 'Search' can not be used together with 'Frame-ring-MB' or 'CE-stats'." << std::endl;
+    return -1;
+  }
+  // the latencies are recorded during receiving, before the hardware timestamps could be converted (see timestamp.h)
+  if (latency_histogram && hw_timestamp)
+  {
+    std::cerr << "Input Error: 'Latency-histogram' can not be used together with 'HW-timestamp'." << std::endl;
+    return -1;
+  }
+  // the CE arrays generated with a random seed are not reproducible (see cecache.h)
+  if (ce_cache[0] && !ce_seed)
+  {
+    std::cerr << "Input Error: 'CE-cache' requires a non-zero 'CE-seed'." << std::endl;
+    return -1;
+  }
 
   return 0;
 }
@@ -507,10 +823,11 @@ int Throughput::readCmdLine(int argc, const char *argv[])
   }
   // Further checking of the frame size will be done, when n and m are read.
   ipv4_frame_size = ipv6_frame_size - 20;
-  if (sscanf(argv[2], "%u", &frame_rate) != 1 || frame_rate < 1 || frame_rate > 14880952)
+  if (sscanf(argv[2], "%u", &frame_rate) != 1 || frame_rate < 1 || frame_rate > 148809523)
   {
-    // 14,880,952 is the maximum frame rate for 10Gbps Ethernet using 64-byte frame size
-    std::cerr << "Input Error: Frame rate must be between 1 and 14880952." << std::endl;
+    // 148,809,523 is the maximum frame rate for 100Gbps Ethernet using 64-byte frame size
+    // (higher rates than what a single core can produce require several sender cores, see 'CPU-FW-Send' and 'CPU-RV-Send')
+    std::cerr << "Input Error: Frame rate must be between 1 and 148809523." << std::endl;
     return -1;
   }
   if (sscanf(argv[3], "%hu", &test_duration) != 1 || test_duration < 1 || test_duration > 3600)
@@ -533,6 +850,17 @@ int Throughput::readCmdLine(int argc, const char *argv[])
     std::cerr << "Input Error: Cannot read the value of 'm'." << std::endl;
     return -1;
   }
+  if (!pacerTableSize(pacer_profile, pacer_burst, pacer_period, frame_rate))
+  {
+    // a period of the sinusoidal profile must contain at least 2 and at most PACER_MAX_TABLE frames
+    std::cerr << "Input Error: 'Pacer-period' must contain between 2 and " << PACER_MAX_TABLE << " frames at the given frame rate." << std::endl;
+    return -1;
+  }
+  if (search && search_low >= frame_rate)
+  {
+    std::cerr << "Input Error: 'Search-low' must be less than the frame rate (the upper bound of the binary search)." << std::endl;
+    return -1;
+  }
 
   return 0;
 }
@@ -542,7 +870,6 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
 {
   const char *rte_argv[6];                                                     // parameters for DPDK EAL init, e.g.: {NULL, "-l", "4,5,6,7", "-n", "2", NULL};
   int rte_argc = static_cast<int>(sizeof(rte_argv) / sizeof(rte_argv[0])) - 1; // argc value for DPDK EAL init
-  struct rte_eth_conf cfg_port;                                                // for configuring the Ethernet ports
   struct rte_eth_link link_info;                                               // for retrieving link info by rte_eth_link_get()
   int trials;                                                                  // cycle variable for port state checking
 
@@ -550,16 +877,24 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
   rte_argv[0] = argv0; // program name
   rte_argv[1] = "-l";  // list of lcores will follow
   // Only lcores for the active directions are to be included (at least one of them MUST be non-zero)
-  if (forward && reverse)
+  coresList = "0";
+  if (forward)
   {
-    // both directions are active
-    snprintf(coresList, 101, "0,%d,%d,%d,%d", left_sender_cpu, right_receiver_cpu, right_sender_cpu, left_receiver_cpu);
+    // forward (left to right) is active
+    for (int q = 0; q < num_left_senders; q++)
+      coresList += "," + std::to_string(left_sender_cpus[q]);
+    for (int q = 0; q < num_right_receivers; q++)
+      coresList += "," + std::to_string(right_receiver_cpus[q]);
   }
-  else if (forward)
-    snprintf(coresList, 101, "0,%d,%d", left_sender_cpu, right_receiver_cpu); // only forward (left to right) is active
-  else
-    snprintf(coresList, 101, "0,%d,%d", right_sender_cpu, left_receiver_cpu); // only reverse (right to left) is active
-  rte_argv[2] = coresList;
+  if (reverse)
+  {
+    // reverse (right to left) is active
+    for (int q = 0; q < num_right_senders; q++)
+      coresList += "," + std::to_string(right_sender_cpus[q]);
+    for (int q = 0; q < num_left_receivers; q++)
+      coresList += "," + std::to_string(left_receiver_cpus[q]);
+  }
+  rte_argv[2] = coresList.c_str();
   rte_argv[3] = "-n";
   snprintf(numChannels, 11, "%hhu", memory_channels);
   rte_argv[4] = numChannels;
@@ -583,83 +918,116 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
     return -1;
   }
 
-  // prepare for configuring the Ethernet ports
-  memset(&cfg_port, 0, sizeof(cfg_port));   // e.g. no CRC generation offloading, etc. (May be improved later!)
-  cfg_port.txmode.mq_mode = ETH_MQ_TX_NONE; // no multi queues
-  cfg_port.rxmode.mq_mode = ETH_MQ_RX_NONE; // no multi queues
-
-  if (rte_eth_dev_configure(leftport, 1, 1, &cfg_port) < 0)
+  // a port has as many TX queues as the number of senders and as many RX queues as the number of receivers using it
+  // (at least one of each, see the remark below)
+  // checksum offload and frame split are used by the senders of a port, if they are requested and the port supports them
+  // (and so are the hardware timestamps by the senders and receivers, see also enableTimesync())
+  left_chksum_offload = right_chksum_offload = tx_chksum_offload;
+  left_frame_split = right_frame_split = frame_split;
+  left_hw_rx_ts = right_hw_rx_ts = left_hw_tx_ts = right_hw_tx_ts = hw_timestamp;
+  // the TX timestamp is latched by the port, thus the Latency Frames of several Senders could take each other's timestamp
+  if (left_hw_tx_ts && num_left_senders > 1)
   {
-    std::cerr << "Error: Cannot configure network port #" << leftport << " provided as Left Port, Tester exits." << std::endl;
-    return -1;
+    left_hw_tx_ts = false;
+    std::cout << "Warning: Left Port has several Senders, they use software TX timestamps." << std::endl;
   }
-
-  if (rte_eth_dev_configure(rightport, 1, 1, &cfg_port) < 0)
+  if (right_hw_tx_ts && num_right_senders > 1)
   {
-    std::cerr << "Error: Cannot configure network port #" << rightport << " provided as Right Port, Tester exits." << std::endl;
-    return -1;
+    right_hw_tx_ts = false;
+    std::cout << "Warning: Right Port has several Senders, they use software TX timestamps." << std::endl;
   }
+  if (configurePort(leftport, std::max(num_left_receivers, 1), std::max(num_left_senders, 1), "Left", &left_chksum_offload, &left_frame_split, &left_hw_rx_ts, &left_tx_ring_size) < 0)
+    return -1;
+  if (configurePort(rightport, std::max(num_right_receivers, 1), std::max(num_right_senders, 1), "Right", &right_chksum_offload, &right_frame_split, &right_hw_rx_ts, &right_tx_ring_size) < 0)
+    return -1;
 
   // Important remark: with no regard whether actual test will be performed in the forward or reverese direcetion,
   // all TX and RX queues MUST be set up properly, otherwise rte_eth_dev_start() will cause segmentation fault.
   // Sender pool size calculation uses 0 instead of num_{left,right}_nets, when no actual frame sending is needed.
 
   // calculate packet pool sizes and then create the pools
-  int left_sender_pool_size = senderPoolSize();
-  int right_sender_pool_size = senderPoolSize();
+  // the number of template frames depends on the TX ring size of the port (see templateCount())
+  left_num_of_templates = templateCount(left_tx_ring_size, tx_burst_size);
+  right_num_of_templates = templateCount(right_tx_ring_size, tx_burst_size);
+  int left_sender_pool_size = senderPoolSize(left_num_of_templates);
+  int right_sender_pool_size = senderPoolSize(right_num_of_templates);
   int receiver_pool_size = PORT_RX_QUEUE_SIZE + 2 * MAX_PKT_BURST + 100; // While one of them is processed, the other one is being filled.
 
-  pkt_pool_left_sender = rte_pktmbuf_pool_create("pp_left_sender", left_sender_pool_size, PKTPOOL_CACHE, 0,
-                                                 RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(left_sender_cpu));
-  if (!pkt_pool_left_sender)
+  char pool_name[32]; // the names of the sender and receiver pools contain the number of the sender or receiver
+
+  // each sender has its own packet pool in its NUMA node
+  for (int q = 0; q < num_left_senders; q++)
   {
-    std::cerr << "Error: Cannot create packet pool for Left Sender, Tester exits." << std::endl;
-    return -1;
+    snprintf(pool_name, sizeof(pool_name), "pp_left_sender_%d", q);
+    pkt_pool_left_sender[q] = rte_pktmbuf_pool_create(pool_name, left_sender_pool_size, PKTPOOL_CACHE, 0,
+                                                      RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(left_sender_cpus[q]));
+    if (!pkt_pool_left_sender[q])
+    {
+      std::cerr << "Error: Cannot create packet pool for Left Sender #" << q << ", Tester exits." << std::endl;
+      return -1;
+    }
   }
-  pkt_pool_right_receiver = rte_pktmbuf_pool_create("pp_right_receiver", receiver_pool_size, PKTPOOL_CACHE, 0,
-                                                    RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(right_receiver_cpu));
-  if (!pkt_pool_right_receiver)
+  // each receiver has its own packet pool in its NUMA node (an RX queue without a receiver gets its pool in the NUMA node of the port)
+  for (int q = 0; q < std::max(num_right_receivers, 1); q++)
   {
-    std::cerr << "Error: Cannot create packet pool for Right Receiver, Tester exits." << std::endl;
-    return -1;
+    snprintf(pool_name, sizeof(pool_name), "pp_right_receiver_%d", q);
+    pkt_pool_right_receiver[q] = rte_pktmbuf_pool_create(pool_name, receiver_pool_size, PKTPOOL_CACHE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+                                                         num_right_receivers ? rte_lcore_to_socket_id(right_receiver_cpus[q]) : rte_eth_dev_socket_id(rightport));
+    if (!pkt_pool_right_receiver[q])
+    {
+      std::cerr << "Error: Cannot create packet pool for Right Receiver #" << q << ", Tester exits." << std::endl;
+      return -1;
+    }
   }
 
-  pkt_pool_right_sender = rte_pktmbuf_pool_create("pp_right_sender", right_sender_pool_size, PKTPOOL_CACHE, 0,
-                                                  RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(right_sender_cpu));
-  if (!pkt_pool_right_sender)
+  for (int q = 0; q < num_right_senders; q++)
   {
-    std::cerr << "Error: Cannot create packet pool for Right Sender, Tester exits." << std::endl;
-    return -1;
+    snprintf(pool_name, sizeof(pool_name), "pp_right_sender_%d", q);
+    pkt_pool_right_sender[q] = rte_pktmbuf_pool_create(pool_name, right_sender_pool_size, PKTPOOL_CACHE, 0,
+                                                       RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(right_sender_cpus[q]));
+    if (!pkt_pool_right_sender[q])
+    {
+      std::cerr << "Error: Cannot create packet pool for Right Sender #" << q << ", Tester exits." << std::endl;
+      return -1;
+    }
   }
-  pkt_pool_left_receiver = rte_pktmbuf_pool_create("pp_left_receiver", receiver_pool_size, PKTPOOL_CACHE, 0,
-                                                   RTE_MBUF_DEFAULT_BUF_SIZE, rte_lcore_to_socket_id(left_receiver_cpu));
-  if (!pkt_pool_left_receiver)
+  for (int q = 0; q < std::max(num_left_receivers, 1); q++)
   {
-    std::cerr << "Error: Cannot create packet pool for Left Receiver, Tester exits." << std::endl;
-    return -1;
+    snprintf(pool_name, sizeof(pool_name), "pp_left_receiver_%d", q);
+    pkt_pool_left_receiver[q] = rte_pktmbuf_pool_create(pool_name, receiver_pool_size, PKTPOOL_CACHE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+                                                        num_left_receivers ? rte_lcore_to_socket_id(left_receiver_cpus[q]) : rte_eth_dev_socket_id(leftport));
+    if (!pkt_pool_left_receiver[q])
+    {
+      std::cerr << "Error: Cannot create packet pool for Left Receiver #" << q << ", Tester exits." << std::endl;
+      return -1;
+    }
   }
 
   // set up the TX/RX queues
-  if (rte_eth_tx_queue_setup(leftport, 0, PORT_TX_QUEUE_SIZE, rte_eth_dev_socket_id(leftport), NULL) < 0)
-  {
-    std::cerr << "Error: Cannot setup TX queue for Left Sender, Tester exits." << std::endl;
-    return -1;
-  }
-  if (rte_eth_rx_queue_setup(rightport, 0, PORT_RX_QUEUE_SIZE, rte_eth_dev_socket_id(rightport), NULL, pkt_pool_right_receiver) < 0)
-  {
-    std::cerr << "Error: Cannot setup RX queue for Right Receiver, Tester exits." << std::endl;
-    return -1;
-  }
-  if (rte_eth_tx_queue_setup(rightport, 0, PORT_TX_QUEUE_SIZE, rte_eth_dev_socket_id(rightport), NULL) < 0)
-  {
-    std::cerr << "Error: Cannot setup TX queue for Right Sender, Tester exits." << std::endl;
-    return -1;
-  }
-  if (rte_eth_rx_queue_setup(leftport, 0, PORT_RX_QUEUE_SIZE, rte_eth_dev_socket_id(leftport), NULL, pkt_pool_left_receiver) < 0)
-  {
-    std::cerr << "Error: Cannot setup RX queue for Left Receiver, Tester exits." << std::endl;
-    return -1;
-  }
+  for (int q = 0; q < std::max(num_left_senders, 1); q++)
+    if (rte_eth_tx_queue_setup(leftport, q, left_tx_ring_size, rte_eth_dev_socket_id(leftport), NULL) < 0)
+    {
+      std::cerr << "Error: Cannot setup TX queue #" << q << " for Left Sender, Tester exits." << std::endl;
+      return -1;
+    }
+  for (int q = 0; q < std::max(num_right_receivers, 1); q++)
+    if (rte_eth_rx_queue_setup(rightport, q, PORT_RX_QUEUE_SIZE, rte_eth_dev_socket_id(rightport), NULL, pkt_pool_right_receiver[q]) < 0)
+    {
+      std::cerr << "Error: Cannot setup RX queue #" << q << " for Right Receiver, Tester exits." << std::endl;
+      return -1;
+    }
+  for (int q = 0; q < std::max(num_right_senders, 1); q++)
+    if (rte_eth_tx_queue_setup(rightport, q, right_tx_ring_size, rte_eth_dev_socket_id(rightport), NULL) < 0)
+    {
+      std::cerr << "Error: Cannot setup TX queue #" << q << " for Right Sender, Tester exits." << std::endl;
+      return -1;
+    }
+  for (int q = 0; q < std::max(num_left_receivers, 1); q++)
+    if (rte_eth_rx_queue_setup(leftport, q, PORT_RX_QUEUE_SIZE, rte_eth_dev_socket_id(leftport), NULL, pkt_pool_left_receiver[q]) < 0)
+    {
+      std::cerr << "Error: Cannot setup RX queue #" << q << " for Left Receiver, Tester exits." << std::endl;
+      return -1;
+    }
 
   // start the Ethernet ports
   if (rte_eth_dev_start(leftport) < 0)
@@ -679,6 +1047,12 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
     rte_eth_promiscuous_enable(rightport);
   }
 
+  if (hw_timestamp)
+  {
+    enableTimesync(leftport, "Left", &left_hw_rx_ts, &left_hw_tx_ts);
+    enableTimesync(rightport, "Right", &right_hw_rx_ts, &right_hw_tx_ts);
+  }
+
   // check links' states (wait for coming up), try maximum MAX_PORT_TRIALS times
   trials = 0;
   do
@@ -712,13 +1086,17 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
     {
       if (forward)
       {
-        numaCheck(leftport, "Left", left_sender_cpu, "Left Sender");
-        numaCheck(rightport, "Right", right_receiver_cpu, "Right Receiver");
+        for (int q = 0; q < num_left_senders; q++)
+          numaCheck(leftport, "Left", left_sender_cpus[q], "Left Sender");
+        for (int q = 0; q < num_right_receivers; q++)
+          numaCheck(rightport, "Right", right_receiver_cpus[q], "Right Receiver");
       }
       if (reverse)
       {
-        numaCheck(rightport, "Right", right_sender_cpu, "Right Sender");
-        numaCheck(leftport, "Left", left_receiver_cpu, "Left Receiver");
+        for (int q = 0; q < num_right_senders; q++)
+          numaCheck(rightport, "Right", right_sender_cpus[q], "Right Sender");
+        for (int q = 0; q < num_left_receivers; q++)
+          numaCheck(leftport, "Left", left_receiver_cpus[q], "Left Receiver");
       }
     }
   }
@@ -726,95 +1104,84 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
   // Some sanity checks: TSCs of the used cores are synchronized or not...
   if (forward)
   {
-    check_tsc(left_sender_cpu, "Left Sender");
-    check_tsc(right_receiver_cpu, "Right Receiver");
+    for (int q = 0; q < num_left_senders; q++)
+      check_tsc(left_sender_cpus[q], "Left Sender");
+    for (int q = 0; q < num_right_receivers; q++)
+      check_tsc(right_receiver_cpus[q], "Right Receiver");
   }
   if (reverse)
   {
-    check_tsc(right_sender_cpu, "Right Sender");
-    check_tsc(left_receiver_cpu, "Left Receiver");
+    for (int q = 0; q < num_right_senders; q++)
+      check_tsc(right_sender_cpus[q], "Right Sender");
+    for (int q = 0; q < num_left_receivers; q++)
+      check_tsc(left_receiver_cpus[q], "Left Receiver");
   }
 
-  // prepare further values for testing
-  hz = rte_get_timer_hz();                                                       // number of clock cycles per second
-  start_tsc = rte_rdtsc() + hz * START_DELAY / 1000;                             // Each active sender starts sending at this time
-  finish_receiving = start_tsc + hz * (test_duration + stream_timeout / 1000.0); // Each receiver stops at this time
-
   // producing some important values from the BMR configuration parameters for the next tasks (e.g., generating the pseudorandom EA combinations)
   bmr_ipv4_suffix_length = 32 - bmr_ipv4_prefix_length;
+  if (bmr_EA_length < bmr_ipv4_suffix_length || bmr_EA_length > bmr_ipv4_suffix_length + 16)
+  {
+    std::cerr << "Config Error: 'BMR-EA-length' must be between the IPv4 suffix length (" << (int)bmr_ipv4_suffix_length << ") and 16 bits more (the PSID is at most 16 bits)." << std::endl;
+    return -1;
+  }
   psid_length = bmr_EA_length - bmr_ipv4_suffix_length;
   num_of_port_sets = pow(2.0, psid_length);
   num_of_ports = (uint16_t)(65536.0 / num_of_port_sets); // 65536.0 denotes the total number of port possibilities can be there in the 16-bit udp port number(i.e., 2 ^ 16)
-  int num_of_suffixes = pow(2.0, bmr_ipv4_suffix_length)-2; //-2 to exclude the subnet and broadcast addresses
-  int max_num_of_CEs = (num_of_suffixes * num_of_port_sets); //maximum possible number of CEs based on the number of EA-bits
+  int64_t num_of_suffixes = (((int64_t)1) << bmr_ipv4_suffix_length) - 2; //-2 to exclude the subnet and broadcast addresses
+  int64_t max_num_of_CEs = num_of_suffixes * num_of_port_sets; //maximum possible number of CEs based on the number of EA-bits
 
   if (num_of_CEs > max_num_of_CEs){
     std::cerr << "Config Error: The number of CEs ("<< num_of_CEs <<") to be simulated exceeds the maximum number that EA-bits allow (" << max_num_of_CEs << ")" << std::endl;
     return -1;
   }
   
-  // pre-generate pseudorandom EA-bits combinations 
-  //and save them in a NUMA local memory (of the same memory of the sender core for fast access)
-  // For this purpose, we used rte_eal_remote_launch() and pack parameters for it
-
-  // prepare the parameters for the randomPermutationGenerator48
-    randomPermutationGeneratorParameters48 pars;
-    pars.ip4_suffix_length = bmr_ipv4_suffix_length;
-    pars.psid_length = psid_length;
-    pars.hz = rte_get_timer_hz(); // number of clock cycles per second;
-    
+  // load the CE arrays of an earlier run with the same parameters, if they are cached (see cecache.h)
+  // the pseudorandom EA-bits combinations are generated and the CE arrays are built only for the directions without them
+  CECache *fwCache = NULL, *rvCache = NULL;
+  if (ce_cache[0])
+  {
     if (forward)
-      {
-        pars.direction = "forward"; 
-        pars.addr_of_arraypointer = &fwUniqueEAComb;
-        // start randomPermutationGenerator32
-        if ( rte_eal_remote_launch(randomPermutationGenerator48, &pars, left_sender_cpu ) )
-          std::cerr << "Error: could not start randomPermutationGenerator48() for pre-generating unique EA-bits combinations at the " << pars.direction << " sender" << std::endl;
-        rte_eal_wait_lcore(left_sender_cpu);
-      }
+    {
+      fwCache = new CECache(ce_cache, true, num_of_CEs, ce_seed, &bmr_ipv6_prefix, bmr_ipv6_prefix_length, bmr_ipv4_prefix, bmr_ipv4_prefix_length, bmr_EA_length);
+      fwCE = fwCache->load(rte_lcore_to_socket_id(left_sender_cpus[0]), "forward");
+    }
     if (reverse)
-      {
-        pars.direction = "reverse";
-        pars.addr_of_arraypointer = &rvUniqueEAComb;
-        // start randomPermutationGenerator32
-        if ( rte_eal_remote_launch(randomPermutationGenerator48, &pars, right_sender_cpu ) )
-          std::cerr << "Error: could not start randomPermutationGenerator48() for pre-generating unique EA-bits combinations at the " << pars.direction << " sender" << std::endl;
-        rte_eal_wait_lcore(right_sender_cpu);
-      }
-
-  // pre-generate the array of CEs Data (MAP addresses and others) 
-  //and save it in a NUMA local memory (of the same memory of the sender core for fast access)
-  // For this purpose, we used rte_eal_remote_launch() and pack parameters for it
-
-  CEArrayBuilderParameters param;
-  param.bmr_ipv4_suffix_length = bmr_ipv4_suffix_length; 
-  param.psid_length =  psid_length;            
-  param.num_of_CEs = num_of_CEs;             
-  param.bmr_ipv6_prefix = bmr_ipv6_prefix; 
-  param.bmr_ipv6_prefix_length = bmr_ipv6_prefix_length;  
-  param.bmr_ipv4_prefix = bmr_ipv4_prefix;        
-  param.hz = rte_get_timer_hz(); // number of clock cycles per second			
-  
-  if (forward)
     {
-      param.direction = "forward"; 
-      param.UniqueEAComb = fwUniqueEAComb;       
-      param.addr_of_arraypointer = &fwCE;
-      // start randomPermutationGenerator32
-        if ( rte_eal_remote_launch(buildCEArray, &param, left_sender_cpu ) )
-          std::cerr << "Error: could not start buildCEArray() for pre-generating the array of CEs data at the " << param.direction << " sender" << std::endl;
-        rte_eal_wait_lcore(left_sender_cpu);
-      }
-  if (reverse)
-      {
-        param.direction = "reverse";
-        param.UniqueEAComb = rvUniqueEAComb;       
-        param.addr_of_arraypointer = &rvCE;
-        // start randomPermutationGenerator32
-        if ( rte_eal_remote_launch(buildCEArray, &param, right_sender_cpu ) )
-             std::cerr << "Error: could not start buildCEArray() for pre-generating the array of CEs data at the " << param.direction << " sender" << std::endl;
-        rte_eal_wait_lcore(right_sender_cpu);
-      }
+      rvCache = new CECache(ce_cache, false, num_of_CEs, ce_seed, &bmr_ipv6_prefix, bmr_ipv6_prefix_length, bmr_ipv4_prefix, bmr_ipv4_prefix_length, bmr_EA_length);
+      rvCE = rvCache->load(rte_lcore_to_socket_id(right_sender_cpus[0]), "reverse");
+    }
+  }
+  bool fw_cached = fwCE != NULL, rv_cached = rvCE != NULL;
+
+  // pre-generate the arrays of CEs Data (MAP addresses and others) from a pseudorandom enumeration of the EA-bits combinations (see eaperm.h)
+  // and save them in a NUMA local memory (of the same memory of the sender core for fast access)
+  // If a direction has several senders, they share the array (each of them uses an interleaved slice).
+  buildCEArrays(forward && !fw_cached, reverse && !rv_cached);
+
+  // save the newly built CE arrays into the cache
+  if (fwCache && !fw_cached)
+    fwCache->save(fwCE, "forward");
+  if (rvCache && !rv_cached)
+    rvCache->save(rvCE, "reverse");
+  delete fwCache;
+  delete rvCache;
+
+  // extract the hot records of the senders from the loaded CE arrays (those of the built ones are extracted by buildCEArray())
+  // The full CE arrays are used by the validators and the per-CE accounting.
+  reserveHotCEs();
+  if (fw_cached)
+    extractHotCEs(fwCE, fwHotCE, NULL, 0, num_of_CEs);
+  if (rv_cached)
+    extractHotCEs(rvCE, NULL, rvHotCE, 0, num_of_CEs);
+
+  // generate the streams of the CE indices of the non-sequential CE orders (in the memory of the senders)
+  if (ce_order != CE_ORDER_SEQUENTIAL)
+  {
+    if (forward)
+      fwOrder = new CEOrder(ce_order, num_of_CEs, ce_skew, ce_hot_ces, ce_hot_load, ce_seed, 0, rte_lcore_to_socket_id(left_sender_cpus[0]), "forward");
+    if (reverse)
+      rvOrder = new CEOrder(ce_order, num_of_CEs, ce_skew, ce_hot_ces, ce_hot_load, ce_seed, 1, rte_lcore_to_socket_id(right_sender_cpus[0]), "reverse");
+  }
 
   // Construct the DMR ipv6 address (It will be the destination address in the forward direction in case of the foreground traffic)
  // Based on section 2.2 of RFC 6052, The possible DMR prefix length are 32, 40, 48, 56, 64, and 96.
@@ -836,14 +1203,134 @@ int Throughput::init(const char *argv0, uint16_t leftport, uint16_t rightport)
     dmr_ipv6.s6_addr[9 + i] = (unsigned char)(ntohl(tester_right_ipv4) >> (((num_octets_after_u - 1) - i) * 8));
  }
 
-  return 0;
-}
-
-// calculates sender pool size, it is a virtual member function, redefined in derived classes
-int Throughput::senderPoolSize()
+  // build the expectation tables of the translation validators from the CE arrays (in the memory of the receivers)
+  if (validate)
+  {
+    if (forward)
+      fwValidator = new Validator(true, fwCE, num_of_CEs, bmr_ipv4_prefix, bmr_ipv4_suffix_length, psid_length, tester_right_ipv4, &dmr_ipv6,
+                                  &tester_left_ipv6, &tester_right_ipv6, rte_eth_dev_socket_id(rightport));
+    if (reverse)
+      rvValidator = new Validator(false, rvCE, num_of_CEs, bmr_ipv4_prefix, bmr_ipv4_suffix_length, psid_length, tester_right_ipv4, &dmr_ipv6,
+                                  &tester_left_ipv6, &tester_right_ipv6, rte_eth_dev_socket_id(leftport));
+  }
+
+  // build the CE index tables of the per-CE accounting from the CE arrays
+  if (ce_stats)
+  {
+    if (forward)
+      fwCEStats = new CEStats(true, fwCE, fwOrder, num_of_CEs, bmr_ipv4_suffix_length, psid_length, &tester_right_ipv6, right_receiver_cpus, num_right_receivers);
+    if (reverse)
+      rvCEStats = new CEStats(false, rvCE, rvOrder, num_of_CEs, bmr_ipv4_suffix_length, psid_length, &tester_left_ipv6, left_receiver_cpus, num_left_receivers);
+  }
+
+  // prepare further values for testing (after the potentially long preparation of the CE arrays and tables above)
+  hz = rte_get_timer_hz();                                                       // number of clock cycles per second
+  start_tsc = rte_rdtsc() + hz * START_DELAY / 1000;                             // Each active sender starts sending at this time
+  finish_receiving = start_tsc + hz * (test_duration + stream_timeout / 1000.0); // Each receiver stops at this time
+
+  return 0;
+}
+
+// calculates sender pool size, it is a virtual member function, redefined in derived classes
+// As the senders hold their frames (see holdFrame()), the NIC driver never returns them to the pool, thus no further mbufs are needed for the TX ring.
+int Throughput::senderPoolSize(int num_of_templates)
 {
-  return 2 * N + PORT_TX_QUEUE_SIZE + 100; // 2*: fg. and bg. Test Frames
-  // if varport then everything exists in N copies, see the definition of N
+  int generations = search ? 2 : 1; // in a binary search, the NIC may still hold the template frames of the previous trial (see search.h)
+  if (frame_split)
+    return generations * (2 * 2 * num_of_templates + 1) + 100; // 2*: fg. and bg. Test Frames, 2*: header and payload segments, +1: shared payload
+  return generations * 2 * num_of_templates + 100; // 2*: fg. and bg. Test Frames
+}
+
+// configures an Ethernet port with the given number of RX and TX queues
+// If there are several RX queues, RSS distributes the received frames among them on the basis of their IP addresses and UDP ports.
+// If checksum offload is requested (*chksum_offload is true), but the port does not support it, *chksum_offload is cleared,
+// thus the senders of the port fall back to calculating the checksums themselves.
+// Similarly, *frame_split is cleared, if it is requested, but the port can not transmit multi-segment frames.
+// *tx_ring_size is set to the number of descriptors of the TX queues: PORT_TX_QUEUE_SIZE adjusted to the limits of the port.
+int Throughput::configurePort(uint16_t port, int num_rx_queues, int num_tx_queues, const char *port_side, bool *chksum_offload, bool *frame_split, bool *hw_rx_ts, uint16_t *tx_ring_size)
+{
+  uint16_t rx_ring_size = PORT_RX_QUEUE_SIZE; // (only the TX ring size is used)
+  struct rte_eth_conf cfg_port;     // for configuring the Ethernet port
+  struct rte_eth_dev_info dev_info; // for checking the RSS and offload capabilities of the port
+  const uint64_t chksum_offloads = DEV_TX_OFFLOAD_IPV4_CKSUM | DEV_TX_OFFLOAD_UDP_CKSUM;
+
+  rte_eth_dev_info_get(port, &dev_info);
+  memset(&cfg_port, 0, sizeof(cfg_port));   // e.g. no CRC generation offloading, etc.
+  cfg_port.txmode.mq_mode = ETH_MQ_TX_NONE; // no multi queue mode is needed: each sender uses its own TX queue
+  cfg_port.rxmode.mq_mode = ETH_MQ_RX_NONE; // no multi queues, if there is a single receiver
+  if (*chksum_offload)
+  {
+    if ((dev_info.tx_offload_capa & chksum_offloads) == chksum_offloads)
+    {
+      cfg_port.txmode.offloads = chksum_offloads;
+      std::cout << "Info: " << port_side << " Port calculates the IPv4 header and UDP checksums of the Test Frames." << std::endl;
+    }
+    else
+    {
+      *chksum_offload = false;
+      std::cout << "Warning: " << port_side << " Port does not support IPv4 and UDP checksum offload, the Senders calculate the checksums." << std::endl;
+    }
+  }
+  if (*frame_split)
+  {
+    if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_MULTI_SEGS)
+    {
+      cfg_port.txmode.offloads |= DEV_TX_OFFLOAD_MULTI_SEGS;
+      std::cout << "Info: " << port_side << " Port sends the Test Frames as header and shared payload segments." << std::endl;
+    }
+    else
+    {
+      *frame_split = false;
+      std::cout << "Warning: " << port_side << " Port does not support multi-segment frames, the Senders use single segment frames." << std::endl;
+    }
+  }
+  if (*hw_rx_ts)
+  {
+    if (dev_info.rx_offload_capa & DEV_RX_OFFLOAD_TIMESTAMP)
+      cfg_port.rxmode.offloads |= DEV_RX_OFFLOAD_TIMESTAMP;
+    else
+    {
+      *hw_rx_ts = false;
+      std::cout << "Warning: " << port_side << " Port does not support RX timestamps, the Receivers use software timestamps." << std::endl;
+    }
+  }
+  if (num_rx_queues > 1)
+  {
+    cfg_port.rxmode.mq_mode = ETH_MQ_RX_RSS;
+    cfg_port.rx_adv_conf.rss_conf.rss_key = NULL; // the default key of the driver is used
+    cfg_port.rx_adv_conf.rss_conf.rss_hf = (ETH_RSS_IP | ETH_RSS_UDP) & dev_info.flow_type_rss_offloads;
+    if (!cfg_port.rx_adv_conf.rss_conf.rss_hf)
+    {
+      std::cerr << "Error: " << port_side << " Port does not support RSS for IP or UDP, thus it cannot have several Receivers, Tester exits." << std::endl;
+      return -1;
+    }
+  }
+  if (rte_eth_dev_configure(port, num_rx_queues, num_tx_queues, &cfg_port) < 0)
+  {
+    std::cerr << "Error: Cannot configure network port #" << port << " provided as " << port_side << " Port, Tester exits." << std::endl;
+    return -1;
+  }
+  *tx_ring_size = PORT_TX_QUEUE_SIZE;
+  if (rte_eth_dev_adjust_nb_rx_tx_desc(port, &rx_ring_size, tx_ring_size) < 0)
+  {
+    std::cerr << "Error: Cannot adjust the TX ring size of network port #" << port << " provided as " << port_side << " Port, Tester exits." << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+// enables the IEEE 1588 clock of a started port, which is needed for its hardware timestamps (see timestamp.h)
+// Without it, neither the TX timestamps, nor the RX timestamps can be used.
+void Throughput::enableTimesync(uint16_t port, const char *port_side, bool *hw_rx_ts, bool *hw_tx_ts)
+{
+  struct timespec ts;
+  if (rte_eth_timesync_enable(port) == 0 && rte_eth_timesync_read_time(port, &ts) == 0)
+    std::cout << "Info: " << port_side << " Port provides hardware timestamps:" << (*hw_tx_ts ? " TX" : "") << (*hw_rx_ts ? " RX" : "") << std::endl;
+  else
+  {
+    *hw_rx_ts = *hw_tx_ts = false;
+    std::cout << "Warning: " << port_side << " Port does not support IEEE 1588 timesync, the Tester uses software timestamps." << std::endl;
+  }
 }
 
 // checks NUMA localty: is the NUMA node of network port and CPU the same?
@@ -996,19 +1483,133 @@ void mkIpv6Header(struct ipv6_hdr *ip, uint16_t length, struct in6_addr *src_ip,
   rte_mov16((uint8_t *)&ip->dst_addr, (uint8_t *)dst_ip);
 }
 
-// concatenates two uint64_t values to form an IPv6 address
-// It is used to concatenate the end user IPv6 prefix and the interface ID to form the MAP address
-struct in6_addr concatenate(uint64_t in1, uint64_t in2)
+// calculates the size of a pre-rendered frame in the ring
+// In frame split mode, only the headers of the frames are pre-rendered (an IPv6 header segment is the longest).
+uint16_t ringFrameSize(uint16_t ipv6_frame_size, bool frame_split)
+{
+  return frame_split ? sizeof(struct ether_hdr) + sizeof(struct ipv6_hdr) + sizeof(struct udp_hdr) + SPLIT_DATA : ipv6_frame_size;
+}
+
+// calculates the number of frames fitting into the memory budget of the ring of pre-rendered frames
+// The result is a multiple of n, thus the foreground/background pattern of the frames is preserved when the ring is replayed.
+// In frame split mode, a pre-rendered frame consists of two mbufs: its header (frame_size is the size of the header segment)
+// and an indirect segment pointing to the shared payload.
+// Returns 0, if the ring is not used or it could not hold even n frames.
+uint64_t frameRingSize(uint32_t frame_ring_mb, uint16_t frame_size, bool frame_split, uint32_t n, uint64_t frames_to_send)
 {
+  uint64_t elt_size = (frame_split ? 2 : 1) * (sizeof(struct rte_mbuf) + RTE_PKTMBUF_HEADROOM + frame_size); // memory needed by one pre-rendered frame
+  uint64_t ring_size = (uint64_t)frame_ring_mb * 1024 * 1024 / elt_size;
+  if (ring_size >= frames_to_send)
+    return frames_to_send; // all the frames can be pre-rendered, no replay is necessary
+  return ring_size - ring_size % n;
+}
 
-  unsigned char out[16] = {(unsigned char)(in1 >> 56), (unsigned char)(in1 >> 48), (unsigned char)(in1 >> 40), (unsigned char)(in1 >> 32),
-                           (unsigned char)(in1 >> 24), (unsigned char)(in1 >> 16), (unsigned char)(in1 >> 8), (unsigned char)in1,
-                           (unsigned char)(in2 >> 56), (unsigned char)(in2 >> 48), (unsigned char)(in2 >> 40), (unsigned char)(in2 >> 32),
-                           (unsigned char)(in2 >> 24), (unsigned char)(in2 >> 16), (unsigned char)(in2 >> 8), (unsigned char)in2};
-  struct in6_addr out_addr = IN6ADDR_ANY_INIT;
-  rte_memcpy(out_addr.s6_addr, out, sizeof(out));
+// calculates how many frames may be sent in a single burst by one of the num_of_queues senders of a direction
+// The frames of a sender follow each other by num_of_queues/frame_rate seconds, thus the last frame of a burst is sent
+// (burst-1)*num_of_queues/frame_rate seconds earlier than due, which must not exceed tx_max_skew microseconds.
+uint16_t burstLimit(uint16_t tx_burst_size, uint16_t tx_max_skew, uint32_t frame_rate, uint16_t num_of_queues)
+{
+  uint64_t skew_frames = (uint64_t)tx_max_skew * frame_rate / (1000000ULL * num_of_queues) + 1; // +1: the first frame of the burst is sent in time
+  return skew_frames < tx_burst_size ? skew_frames : tx_burst_size;
+}
 
-  return out_addr;
+// calculates the number of template frames of each kind, which ensures that no template frame is updated while the NIC still owns it
+// A template frame is used again only after num_of_templates-1 other frames, out of which at most tx_burst_size-1 frames are
+// still pending in TxBurst, thus at least tx_ring_size frames have been handed over to the TX queue after it. As every frame
+// occupies at least one descriptor, the descriptor of the template frame has been reused, and the driver has released the frame by then.
+int templateCount(uint16_t tx_ring_size, uint16_t tx_burst_size)
+{
+  return tx_ring_size + tx_burst_size;
+}
+
+// measurement policy of the throughput (and frame loss rate) tests: the frames are sent as they are (see generator.h)
+class MeasurePlain
+{
+public:
+  TxBurst &tx;
+  MeasurePlain(TxBurst &tx_) : tx(tx_){};
+  inline FrameFields *tagged(uint64_t sent_frames, bool fg) { return NULL; }
+  inline void patch(FrameFields *f, uint64_t sent_frames, uint32_t &chksum) {}
+  inline void send(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames, bool tagged) { tx.add(pkt_mbuf, sent_frames); }
+};
+
+// measurement policy of the throughput tests with sequence numbers: the ordinal number of the frame is written into it (see sequence.h)
+// The template frames contain the beginning of the data pattern of mkData() in the place of the sequence number,
+// whose checksum is to be subtracted from the UDP checksum: it is done by adding its one's complement.
+class MeasureSeq
+{
+public:
+  TxBurst &tx;
+  uint16_t pattern_chksum; // the one's complement of the checksum of the original content of the field
+  MeasureSeq(TxBurst &tx_) : tx(tx_)
+  {
+    uint8_t data[16];
+    mkData(data, 16);
+    pattern_chksum = ~rte_raw_cksum(data + 8, 8);
+  };
+  inline FrameFields *tagged(uint64_t sent_frames, bool fg) { return NULL; }
+  inline void patch(FrameFields *f, uint64_t sent_frames, uint32_t &chksum)
+  {
+    *f->counter = sent_frames; // set the sequence number in the frame
+    chksum += rte_raw_cksum(&sent_frames, 8) + pattern_chksum; // and replace the checksum of the pattern with its checksum
+  }
+  inline void send(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames, bool tagged) { tx.add(pkt_mbuf, sent_frames); }
+};
+
+// policy for pre-rendering the frames of the throughput tests: the finished frames are copied into the frame ring
+class MeasureRender
+{
+public:
+  struct rte_mbuf **ring; // the ring of the pre-rendered frames
+  rte_mempool *ring_pool; // the packet pool of the above frames
+  const char *direction;
+  uint64_t rendered;      // the number of frames already copied into the ring
+  MeasureRender(struct rte_mbuf **ring_, rte_mempool *ring_pool_, const char *direction_) : ring(ring_), ring_pool(ring_pool_), direction(direction_), rendered(0){};
+  inline FrameFields *tagged(uint64_t sent_frames, bool fg) { return NULL; }
+  inline void patch(FrameFields *f, uint64_t sent_frames, uint32_t &chksum) {}
+  inline void send(struct rte_mbuf *pkt_mbuf, uint64_t sent_frames, bool tagged)
+  {
+    struct rte_mbuf *r = ring[rendered++] = rte_pktmbuf_alloc(ring_pool);
+    if (!r)
+      rte_exit(EXIT_FAILURE, "Error: %s sender can't allocate a new mbuf for the pre-rendered frame ring!\n", direction);
+    r->pkt_len = pkt_mbuf->pkt_len;
+    r->data_len = pkt_mbuf->data_len;
+    r->ol_flags = pkt_mbuf->ol_flags; // checksum offload (if any)
+    r->l2_len = pkt_mbuf->l2_len;
+    r->l3_len = pkt_mbuf->l3_len;
+    rte_memcpy(rte_pktmbuf_mtod(r, uint8_t *), rte_pktmbuf_mtod(pkt_mbuf, uint8_t *), pkt_mbuf->data_len);
+    if (pkt_mbuf->next)
+    {
+      // frame split mode: only the header is copied, the payload segment also points to the shared payload
+      struct rte_mbuf *seg = rte_pktmbuf_alloc(ring_pool);
+      if (!seg)
+        rte_exit(EXIT_FAILURE, "Error: %s sender can't allocate a new mbuf for the pre-rendered frame ring!\n", direction);
+      rte_pktmbuf_attach(seg, pkt_mbuf->next);
+      r->next = seg;
+      r->nb_segs = 2;
+    }
+  }
+};
+
+// frees the pre-rendered frame ring of a sender and its packet pool after the replay
+// The frames still owned by the NIC return to the pool only when the driver releases them, thus the pool is freed only after
+// all of them have returned (see also FrameGenerator::waitRelease()), otherwise it is kept, as the NIC may still read them.
+void freeFrameRing(struct rte_mbuf **ring, uint64_t ring_size, rte_mempool *ring_pool, uint8_t eth_id, uint16_t queue_id, const char *direction)
+{
+  uint64_t deadline = rte_rdtsc() + REUSE_TIMEOUT * rte_get_tsc_hz() / 1000;
+  for (uint64_t i = 0; i < ring_size; i++)
+    rte_pktmbuf_free(ring[i]);
+  rte_free(ring);
+  while (!rte_mempool_full(ring_pool))
+  {
+    rte_eth_tx_done_cleanup(eth_id, queue_id, 0); // 0: as many frames as possible
+    if (rte_rdtsc() > deadline)
+    {
+      printf("Warning: the NIC did not release the pre-rendered frames of the %s sender #%u in %u ms, their pool is not freed.\n", direction, queue_id, REUSE_TIMEOUT);
+      return;
+    }
+  }
+  rte_mempool_free(ring_pool);
 }
 
 // sends Test Frames for throughput (or frame loss rate) measurement
@@ -1020,561 +1621,344 @@ int send(void *par)
 
   // parameters directly correspond to the data members of class Throughput
   uint16_t ipv6_frame_size = cp->ipv6_frame_size;
-  uint16_t ipv4_frame_size = cp->ipv4_frame_size;
   uint32_t frame_rate = cp->frame_rate;
   uint16_t test_duration = cp->test_duration;
   uint32_t n = cp->n;
-  uint32_t m = cp->m;
   uint64_t hz = cp->hz;
   uint64_t start_tsc = cp->start_tsc;
-  uint32_t num_of_CEs = cp->num_of_CEs;
-  uint16_t num_of_port_sets = cp->num_of_port_sets;
-  uint16_t num_of_ports = cp->num_of_ports;
-  struct in6_addr *tester_l_ipv6 = cp->tester_l_ipv6;
-  uint32_t *tester_r_ipv4 = cp->tester_r_ipv4;
-  struct in6_addr *dmr_ipv6 = cp->dmr_ipv6;
-  struct in6_addr *tester_r_ipv6 = cp->tester_r_ipv6;
-  uint16_t bg_dport_min = cp->bg_dport_min; 
-  uint16_t bg_dport_max = cp->bg_dport_max; 
-  uint16_t bg_sport_min = cp->bg_sport_min; 
-  uint16_t bg_sport_max = cp->bg_sport_max;
+  uint16_t tx_burst_size = cp->tx_burst_size;
+  uint16_t tx_max_skew = cp->tx_max_skew;
+  uint32_t frame_ring_mb = cp->frame_ring_mb;
 
   // parameters which are different for the Left sender and the Right sender
-  rte_mempool *pkt_pool = p->pkt_pool;
   uint8_t eth_id = p->eth_id;
+  uint16_t queue_id = p->queue_id;
+  uint16_t num_of_queues = p->num_of_queues;
   const char *direction = p->direction;
-  CE_data *CE_array = p->CE_array;
-  struct ether_addr *dst_mac = p->dst_mac;
-  struct ether_addr *src_mac = p->src_mac;
-  unsigned var_sport = p->var_sport;
-  unsigned var_dport = p->var_dport;
-  uint16_t preconfigured_port_min = p->preconfigured_port_min;
-  uint16_t preconfigured_port_max = p->preconfigured_port_max;
 
   // further local variables
-  uint64_t frames_to_send = test_duration * frame_rate; // Each active sender sends this number of frames
-  uint64_t sent_frames = 0;                             // counts the number of sent frames
-  double elapsed_seconds;                               // for checking the elapsed seconds during sending
-
-  // temperoray initial IP addresses that will be put in the template packets and they will be changed later in the sending loop
-  // useful to calculate correct checksums 
-  //(more specifically, the uncomplemented checksum start value after calculating it by the DPDK rte_ipv4_cksum(), rte_ipv4_udptcp_cksum(), and rte_ipv6_udptcp_cksum() functions
-  // when creating the template packets)
-  uint32_t zero_dst_ipv4;
-  struct in6_addr zero_src_ipv6;
-  
-  // the dst_ipv4 must initially be "0.0.0.0" in order for the ipv4 header checksum to be calculated correctly by The rte_ipv4_cksum() 
-  // and for the udp checksum to be calculated correctly the rte_ipv4_udptcp_cksum()
- // and consequently calculate correct checksums in the mKTestFrame4()
-  if (inet_pton(AF_INET, "0.0.0.0", reinterpret_cast<void *>(&zero_dst_ipv4)) != 1)
-  {
-    std::cerr << "Input Error: Bad virt_dst_ipv4 address." << std::endl;
-    return -1;
-  }
-
-  // the src_ipv6 must initially be "::" for the udp checksum to be calculated correctly by the rte_ipv6_udptcp_cksum
-  // and consequently calculate correct checksum in the mKTestFrame6()
-  if (inet_pton(AF_INET6, "::", reinterpret_cast<void *>(&zero_src_ipv6)) != 1)
+  uint64_t frames_to_send = (uint64_t)test_duration * frame_rate;                        // The senders of an active direction send this number of frames together
+  uint64_t own_frames = (frames_to_send + num_of_queues - 1 - queue_id) / num_of_queues; // This sender sends every num_of_queues-th of them
+  uint64_t sent_frames;                                                                  // the ordinal number of the current frame
+  double elapsed_seconds;                                                                // for checking the elapsed seconds during sending
+  double time_limit;                                                                     // the maximum allowed elapsed seconds (see pacer.h)
+
+  FrameGenerator gen(p); // the Test Frame generator (see generator.h)
+
+  // pre-rendered frame ring: before start_tsc, ring_size finished frames are produced by the frame generator,
+  // and then they are replayed, thus the timed sending cycle does nothing else, but pacing and transmission.
+  // The reference count of a frame is increased by TxBurst before each transmission, so the NIC driver never returns it to its pool.
+  // The memory budget is meant for each sender of the direction, and a ring holds the frames of the slice of its sender.
+  // In frame split mode, only the headers of the frames are pre-rendered (see ringFrameSize()).
+  uint16_t ring_frame_size = ringFrameSize(ipv6_frame_size, p->frame_split);
+  uint64_t ring_size = frameRingSize(frame_ring_mb, ring_frame_size, p->frame_split, n, own_frames); // 0 means no pre-rendering
+  uint64_t ring_pos;                       // the position of the next frame to be replayed from the ring
+  struct rte_mbuf **ring = NULL;           // the ring of the pre-rendered frames
+  rte_mempool *ring_pool = NULL;           // the packet pool of the above frames
+  char ring_pool_name[32];                 // the name of the above packet pool
+  if (frame_ring_mb && !ring_size && own_frames)
+    rte_exit(EXIT_FAILURE, "Error: the 'Frame-ring-MB' memory budget of the %s sender is too small for even %u frames!\n", direction, n);
+  if (ring_size)
   {
-    std::cerr << "Input Error: Bad  virt_src_ipv6 address." << std::endl;
-    return -1;
+    snprintf(ring_pool_name, sizeof(ring_pool_name), "pp_ring_%s_%u", direction, queue_id);
+    ring_pool = rte_pktmbuf_pool_create(ring_pool_name, (p->frame_split ? 2 : 1) * ring_size, 0, 0, RTE_PKTMBUF_HEADROOM + ring_frame_size, rte_socket_id());
+    ring = (struct rte_mbuf **)rte_malloc("Pre-rendered frame ring", ring_size * sizeof(struct rte_mbuf *), 128);
+    if (!ring_pool || !ring)
+      rte_exit(EXIT_FAILURE, "Error: Can't allocate NUMA local memory for the pre-rendered frame ring of the %s sender!\n", direction);
+    std::cout << "Info: Pre-rendering " << ring_size << " frames for " << direction << " sender #" << queue_id << "\n";
   }
-  
-  // These addresses are for the foreground traffic in the reverse direction
-  // setting the source ipv4 address of the reverse direction to the ipv4 address of the tester right interface
-  uint32_t *src_ipv4 = tester_r_ipv4;// This would be set without change during testing in the reverse direction.
-                                       // It will represent the ipv4 address of the right interface of the Tester
-  *src_ipv4 = htonl(*src_ipv4);
-  
-  uint32_t *dst_ipv4 = &zero_dst_ipv4; // This would be variable during testing in the reverse direction.
-                                       // It will represent the simulated CE (BMR-ipv4-prefix + suffix)
-                                       // and is merely specified inside the sending loop using the CE_array
-
-  // These addresses are for the foreground traffic in the forward direction
-  struct in6_addr *src_ipv6 = &zero_src_ipv6; // This would be variable during testing in the forward direction.
-                                              // It will represent the simulated CE (MAP address) 
-                                              //and is merely specified inside the sending loop using the CE_array
-                                               
-  struct in6_addr *dst_ipv6 = dmr_ipv6; // This would be set without change during testing in the forward direction.
-                                        // It will represent the DMR IPv6 address.
-
-  // These addresses are for the background traffic only
-  struct in6_addr *src_bg = (direction == "forward" ? tester_l_ipv6 : tester_r_ipv6);  
-  struct in6_addr *dst_bg = (direction == "forward" ? tester_r_ipv6 : tester_l_ipv6); 
-  
-  uint16_t sport_min, sport_max, dport_min, dport_max; // worker port range variables
-  
-// set the relevant ranges to the wide range prespecified in the configuration file (usually comply with RFC 4814)
-// the other ranges that are not set now. They will be set in the sending loop because they are based on the PSID of the
-//pseudorandomly enumerated CE
-  if (direction == "reverse")
-    {
-      sport_min = preconfigured_port_min;
-      sport_max = preconfigured_port_max;
-    }
-  else //forward
-    {
-      dport_min = preconfigured_port_min;
-      dport_max = preconfigured_port_max;
-    }
-  
-  // check whether the CE array is built or not
-   if(!CE_array)
-    rte_exit(EXIT_FAILURE,"No CE array can be accessed by the %s sender",direction);
-    
-  
-  // implementation of varying port numbers recommended by RFC 4814 https://tools.ietf.org/html/rfc4814#section-4.5
-  // RFC 4814 requires pseudorandom port numbers, increasing and decreasing ones are our additional, non-stantard solutions
-  // always one of the same N pre-prepared foreground or background frames is updated and sent,
-  // source and/or destination IP addresses and port number(s), and UDP and IPv4 header checksum are updated
-  // N size arrays are used to resolve the write after send problem
-
-  //some worker variables
-  int i;                                                       // cycle variable for the above mentioned purpose: takes {0..N-1} values
-  int current_CE;                                              // index variable to the current simulated CE in the CE_array
-  uint16_t psid;                                               // working variable for the pseudorandomly enumerated PSID of the currently simulated CE
-  struct rte_mbuf *fg_pkt_mbuf[N], *bg_pkt_mbuf[N], *pkt_mbuf; // pointers of message buffers for fg. and bg. Test Frames
-  uint8_t *pkt;                                                // working pointer to the current frame (in the message buffer)
-  
-  //IP workers
-  uint32_t *fg_dst_ipv4[N]; 
-  struct in6_addr *fg_src_ipv6[N];
-  struct in6_addr *bg_src_ipv6[N], *bg_dst_ipv6[N];
-  uint16_t *fg_ipv4_chksum[N];
-  
-  //UDP workers
-  uint16_t *fg_udp_sport[N], *fg_udp_dport[N], *fg_udp_chksum[N], *bg_udp_sport[N], *bg_udp_dport[N], *bg_udp_chksum[N]; 
-  uint16_t *udp_sport, *udp_dport, *udp_chksum;   
 
-  uint16_t fg_udp_chksum_start, bg_udp_chksum_start, fg_ipv4_chksum_start; // starting values (uncomplemented checksums taken from the original frames created by mKTestFrame functions)                    
-  uint32_t chksum = 0; // temporary variable for UDP checksum calculation
-  uint32_t ip_chksum = 0; //temporary variable for IPv4 header checksum calculation
-  uint16_t sport, dport, bg_sport, bg_dport; // values of source and destination port numbers -- to be preserved, when increase or decrease is done
-  uint16_t sp, dp;                           // values of source and destination port numbers -- temporary values
+  TxBurst tx(eth_id, queue_id, num_of_queues, burstLimit(tx_burst_size, tx_max_skew, frame_rate, num_of_queues), cp, frames_to_send, p->counters);
 
   // creating buffers of template test frames
- for (i = 0; i < N; i++)
-  {
+  gen.mkTemplates(mkTestFrame4, mkTestFrame6);
 
-    // create a foreground Test Frame
-    if (direction == "reverse")
-    {
-
-      fg_pkt_mbuf[i] = mkTestFrame4(ipv4_frame_size, pkt_pool, direction, dst_mac, src_mac, src_ipv4, dst_ipv4, var_sport, var_dport);
-      pkt = rte_pktmbuf_mtod(fg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-      // the source ipv4 address will not be manipulated as it will permenantly be the tester-right-ipv4 (extracted from the dmr-ipv6 as done above)
-      fg_ipv4_chksum[i] = (uint16_t *)(pkt + 24);
-      fg_dst_ipv4[i] = (uint32_t *)(pkt + 30); // The destination ipv4 should be manipulated in the sending loop as it will be the BMR-ipv4-prefix + suffix (i.e. changing each time) in the reverse direction
-      // The source address will not be manipulated as it will permentantly be the IP address of the right interface of the Tester (as done in the initilization above)
-      fg_udp_sport[i] = (uint16_t *)(pkt + 34);
-      fg_udp_dport[i] = (uint16_t *)(pkt + 36);
-      fg_udp_chksum[i] = (uint16_t *)(pkt + 40);
-    }
-    else
-    { //"forward"
-      fg_pkt_mbuf[i] = mkTestFrame6(ipv6_frame_size, pkt_pool, direction, dst_mac, src_mac, src_ipv6, dst_ipv6, var_sport, var_dport);
-      pkt = rte_pktmbuf_mtod(fg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-      fg_src_ipv6[i] = (struct in6_addr *)(pkt + 22);    // The source address should be manipulated as it will be the MAP address (i.e. changing each time) in the forward direction
-      // The destination address will not be manipulated as it will permenantly be the DMR IPv6 address(as done in the initilization above)
-      fg_udp_sport[i] = (uint16_t *)(pkt + 54);
-      fg_udp_dport[i] = (uint16_t *)(pkt + 56);
-      fg_udp_chksum[i] = (uint16_t *)(pkt + 60);
-    }
-    // Always create a backround Test Frame (it is always an IPv6 frame) regardless of the direction of the test
-    // The source and destination IP addresses of the packet have already been set in the initialization above
-    // and they will permenantely be the IP addresses of the left and right interfaces of the Tester 
-    // and based on the direction of the test 
-    bg_pkt_mbuf[i] = mkTestFrame6(ipv6_frame_size, pkt_pool, direction, dst_mac, src_mac, src_bg, dst_bg, var_sport, var_dport);
-    pkt = rte_pktmbuf_mtod(bg_pkt_mbuf[i], uint8_t *); // Access the Test Frame in the message buffer
-    bg_udp_sport[i] = (uint16_t *)(pkt + 54);
-    bg_udp_dport[i] = (uint16_t *)(pkt + 56);
-    bg_udp_chksum[i] = (uint16_t *)(pkt + 60);
-  }
-
-  //save the uncomplemented UDP checksum value (same for all values of [i]). So, [0] is enough
-  fg_udp_chksum_start = ~*fg_udp_chksum[0]; // for the foreground frames 
-  bg_udp_chksum_start = ~*bg_udp_chksum[0]; // same but for the background frames
-  
-  // save the uncomplementd IPv4 header checksum (same for all values of [i]). So, [0] is enough
-  if (direction == "reverse") // in case of foreground IPv4 only
-      fg_ipv4_chksum_start = ~*fg_ipv4_chksum[0]; 
-
-  //  arrays to store the minimum and maximum possible source and destination port numbers in each port set.
-  uint16_t sport_min_for_ps[num_of_port_sets], sport_max_for_ps[num_of_port_sets], dport_min_for_ps[num_of_port_sets], dport_max_for_ps[num_of_port_sets];
-
-  // arrays of indices to know the current source and destination port numbers for each port set, to be used in case of incrementing or decrementing
-  uint16_t curr_sport_for_ps[num_of_port_sets];  // used to restore the last used sport in the port set to set the next sport to.
-  uint16_t curr_dport_for_ps[num_of_port_sets];  // used to restore the last used dport in the port set to set the next dport to.
-  uint16_t curr_sport_for_bg, curr_dport_for_bg; // used to restore the last used port in the background traffic in case the sport or dport are modified in the range of a port set
-
-  for (i = 0; i < num_of_port_sets; i++)
+  if (!ring_size && cp->sequence)
   {
-    // set the port boundaries for each port set
-    sport_min_for_ps[i] = (uint16_t)(i * num_of_ports);
-    sport_max_for_ps[i] = (uint16_t)((i + 1) * num_of_ports) - 1;
-
-    dport_min_for_ps[i] = (uint16_t)(i * num_of_ports);
-    dport_max_for_ps[i] = (uint16_t)((i + 1) * num_of_ports) - 1;
-
-    // set the initial values of port numbers for each port set, depending whether they will be increased (1) or decreased (2)
-    if (var_sport == 1)
-      curr_sport_for_ps[i] = sport_min_for_ps[i];
-    if (var_dport == 1)
-      curr_dport_for_ps[i] = dport_min_for_ps[i];
-    if (var_sport == 2)
-      curr_sport_for_ps[i] = sport_max_for_ps[i];
-    if (var_dport == 2)
-      curr_dport_for_ps[i] = dport_max_for_ps[i];
-  }
-
-  // The sport and dport values are initialized according to wide range of values.
-  // However, for the foreground packets, in the forward direction, the sport_min and sport_max will be set later in the sending loop based on the generated PSID
-  // in the reverse direction, the dport_min and dport_max will be set later in the sending loop based on the generated PSID
-  // No change for bg_sport and bg_dport in case of the background packets.
-  if (var_sport == 1)
-  {
-    sport = sport_min;
-    bg_sport = bg_sport_min;
+    MeasureSeq meas(tx);
+    gen.run(meas, frames_to_send);
   }
-  if (var_sport == 2)
+  else if (!ring_size)
   {
-    sport = sport_max;
-    bg_sport = bg_sport_max;
+    MeasurePlain meas(tx);
+    gen.run(meas, frames_to_send);
   }
-  if (var_dport == 1)
-  {
-    dport = dport_min;
-    bg_dport = bg_dport_min;
-  }
-  if (var_dport == 2)
+  else
   {
-    dport = dport_max;
-    bg_dport = bg_dport_max;
-  }
-
-  i = 0; // increase maunally after each sending
-  current_CE = 0; // increase maunally after each sending
-
-  // prepare random number infrastructure
-  thread_local std::random_device rd_sport;           // Will be used to obtain a seed for the random number engines
-  thread_local std::mt19937_64 gen_sport(rd_sport()); // Standard 64-bit mersenne_twister_engine seeded with rd()
-  thread_local std::random_device rd_dport;           // Will be used to obtain a seed for the random number engines
-  thread_local std::mt19937_64 gen_dport(rd_dport()); // Standard 64-bit mersenne_twister_engine seeded with rd()
-
-  // naive sender version: it is simple and fast
-  for (sent_frames = 0; sent_frames < frames_to_send; sent_frames++)
-  { // Main cycle for the number of frames to send
-    // set the temporary variables (including several pointers) to handle the right pre-generated Test Frame
-
-    if (sent_frames % n < m)
+    MeasureRender render(ring, ring_pool, direction);
+    gen.run(render, queue_id + ring_size * num_of_queues); // the first ring_size frames of the slice
+    if (rte_rdtsc() > start_tsc)
+      rte_exit(EXIT_FAILURE, "Error: pre-rendering the frames of the %s sender took longer than START_DELAY!\n", direction);
+    // replay cycle: the pre-rendered frames are only paced and sent
+    ring_pos = 0;
+    for (sent_frames = queue_id; sent_frames < frames_to_send; sent_frames += num_of_queues)
     {
-      // foreground frame is to be sent
-
-      psid = CE_array[current_CE].psid;
-      chksum = fg_udp_chksum_start; // restore the uncomplemented UDP checksum to add the values of the varying fields
-      udp_sport = fg_udp_sport[i];
-      udp_dport = fg_udp_dport[i];
-      udp_chksum = fg_udp_chksum[i];
-      pkt_mbuf = fg_pkt_mbuf[i];
-
-      if (direction == "forward")
-      {
-
-        *fg_src_ipv6[i] = CE_array[current_CE].map_addr; // set it with the map address
-        chksum += CE_array[current_CE].map_addr_chksum;  // and add its checksum to the UDP checksum
-
-        // the sport_min and sport_max will be set according to the port range values of the selected port set and the sport will retrieve its last value within this range
-        // the dport_min and dport_max will remain on thier default values within the wide range. The dport will be changed based on its value from the last cycle.
-        sport_min = sport_min_for_ps[psid];
-        sport_max = sport_max_for_ps[psid];
-        if (var_sport == 1 || var_sport == 2)
-          sport = curr_sport_for_ps[psid]; // restore the last used sport in the port set to start over from it (useful when increment or decrement; useless when random)
-      }
-
-      if (direction == "reverse")
-      {
-        ip_chksum = fg_ipv4_chksum_start; // restore the uncomplemented IPv4 header checksum to add the checksum value of the destination IPv4 address
-
-        *fg_dst_ipv4[i] = CE_array[current_CE].ipv4_addr; //set it with the CE's IPv4 address
-
-        chksum += CE_array[current_CE].ipv4_addr_chksum; //add its chechsum to the UDP checksum
-        ip_chksum += CE_array[current_CE].ipv4_addr_chksum; //and to the IPv4 header checksum
-
-        ip_chksum = ((ip_chksum & 0xffff0000) >> 16) + (ip_chksum & 0xffff); // calculate 16-bit one's complement sum
-        ip_chksum = ((ip_chksum & 0xffff0000) >> 16) + (ip_chksum & 0xffff); // calculate 16-bit one's complement sum
-        ip_chksum = (~ip_chksum) & 0xffff;                                   // make one's complement
-        if (ip_chksum == 0)                                                  // checksum should not be 0 (0 means, no checksum is used)
-          ip_chksum = 0xffff;
-        *fg_ipv4_chksum[i] = (uint16_t)ip_chksum; //now set the IPv4 header checksum of the packet
-
-        // the dport_min and dport_max will be set according to the port range values of the selected port set and the dport will retrieve its last value within this range
-        // the sport_min and sport_max will remain on thier default values within the wide range. The sport will be changed based on its value from the last cycle.
-        dport_min = dport_min_for_ps[psid];
-        dport_max = dport_max_for_ps[psid];
-        if (var_dport == 1 || var_dport == 2)
-          dport = curr_dport_for_ps[psid]; // restore the last used dport in the ps to start over from it (useful when increment or decrement; useless when random)
-      }
-
-    // time to change the value of the source and destination port numbers
-    if (var_sport)
-    {
-      // sport is varying
-      switch (var_sport)
-      {
-      case 1: // increasing port numbers
-        if ((sp = sport++) == sport_max)
-          sport = sport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((sp = sport--) == sport_min)
-          sport = sport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_sport(sport_min, sport_max); // uniform distribution in [sport_min, sport_max]
-        sp = uni_dis_sport(gen_sport);
-      }
-      *udp_sport = htons(sp); // set the source port 
-      chksum += *udp_sport; // and add it to the UDP checksum
+      tx.add(ring[ring_pos], sent_frames);
+      if (++ring_pos == ring_size)
+        ring_pos = 0;
     }
-    if (var_dport)
-    {
-      // dport is varying
-      switch (var_dport)
-      {
-      case 1: // increasing port numbers
-        if ((dp = dport++) == dport_max)
-          dport = dport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((dp = dport--) == dport_min)
-          dport = dport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_dport(dport_min, dport_max); // uniform distribution in [sport_min, sport_max]
-        dp = uni_dis_dport(gen_dport);
-      }
-      *udp_dport = htons(dp); // set the destination port 
-      chksum += *udp_dport; // and add it to the UDP checksum
-    }
-    if (direction == "forward")
-        curr_sport_for_ps[psid] = sport; // save the current sport of the ps as a starting point for the later use if the same ps will be selected
-      else
-        curr_dport_for_ps[psid] = dport; // save the current dport of the ps as a starting point for the later use if the same ps will be selected
-    }
-    else
-    {
-      // background frame is to be sent
-      // from here, we need to handle the background frame identified by the temporary variables
-
-      chksum = bg_udp_chksum_start; // restore the uncomplemented UDP checksum to add the values of the varying fields
-      udp_sport = bg_udp_sport[i];
-      udp_dport = bg_udp_dport[i];
-      udp_chksum = bg_udp_chksum[i];
-      pkt_mbuf = bg_pkt_mbuf[i];
-  
-    // time to change the value of the source and destination port numbers
-    if (var_sport)
-    {
-      // sport is varying
-      switch (var_sport)
-      {
-      case 1: // increasing port numbers
-        if ((sp = bg_sport++) == bg_sport_max)
-          bg_sport = bg_sport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((sp = bg_sport--) == bg_sport_min)
-          bg_sport = bg_sport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_sport(bg_sport_min, bg_sport_max); // uniform distribution in [sport_min, sport_max]
-        sp = uni_dis_sport(gen_sport);
-      }
-      *udp_sport = htons(sp); // set the source port 
-      chksum += *udp_sport; // and add it to the UDP checksum
-    }
-    if (var_dport)
-    {
-      // dport is varying
-      switch (var_dport)
-      {
-      case 1: // increasing port numbers
-        if ((dp = bg_dport++) == bg_dport_max)
-          bg_dport = bg_dport_min;
-        break;
-      case 2: // decreasing port numbers
-        if ((dp = bg_dport--) == bg_dport_min)
-          bg_dport = bg_dport_max;
-        break;
-      case 3: // pseudorandom port numbers
-        std::uniform_int_distribution<int> uni_dis_dport(bg_dport_min, bg_dport_max); // uniform distribution in [sport_min, sport_max]
-        dp = uni_dis_dport(gen_dport);
-      }
-      *udp_dport = htons(dp); // set the destination port 
-      chksum += *udp_dport; // and add it to the UDP checksum
-    }
-    }
-
-    //finalize the UDP checksum
-    chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // calculate 16-bit one's complement sum
-    chksum = ((chksum & 0xffff0000) >> 16) + (chksum & 0xffff); // calculate 16-bit one's complement sum
-    chksum = (~chksum) & 0xffff;                                // make one's complement
-   
-    if (direction == "reverse")
-      {
-        if (chksum == 0)                                        // checksum should not be 0 (0 means, no checksum is used)
-          chksum = 0xffff;
-      }
-    *udp_chksum = (uint16_t)chksum; // set the UDP checksum in the frame
-
-    // finally, send the frame
-    while (rte_rdtsc() < start_tsc + sent_frames * hz / frame_rate)
-      ; // Beware: an "empty" loop, as well as in the next line
-    while (!rte_eth_tx_burst(eth_id, 0, &pkt_mbuf, 1))
-      ; // send out the frame
-
-    current_CE = (current_CE + 1) % num_of_CEs; // proceed to the next CE element in the CE array
-    i = (i + 1) % N;
-  } // this is the end of the sending cycle
+  }
+  p->sent_frames = own_frames;
 
   // Now, we check the time
   elapsed_seconds = (double)(rte_rdtsc() - start_tsc) / hz;
-  printf("Info: %s sender's sending took %3.10lf seconds.\n", direction, elapsed_seconds);
-  if (elapsed_seconds > test_duration * TOLERANCE)
-    rte_exit(EXIT_FAILURE, "%s sending exceeded the %3.10lf seconds limit, the test is invalid.\n", direction, test_duration * TOLERANCE);
-  printf("%s frames sent: %lu\n", direction, sent_frames);
-  
+  printf("Info: %s sender #%u's sending took %3.10lf seconds.\n", direction, queue_id, elapsed_seconds);
+  time_limit = tx.pacer.timeLimit(test_duration, frames_to_send);
+  if (elapsed_seconds > time_limit)
+    rte_exit(EXIT_FAILURE, "%s sending exceeded the %3.10lf seconds limit, the test is invalid.\n", direction, time_limit);
+  if (ring_size)
+    freeFrameRing(ring, ring_size, ring_pool, eth_id, queue_id, direction);
+
   return 0;
 }
 
 // receives Test Frames for throughput (or frame loss rate) measurements
-// Offsets from the start of the Ethernet Frame:
-// EtherType: 6+6=12
-// IPv6 Next header: 14+6=20, UDP Data for IPv6: 14+40+8=62
-// IPv4 Protolcol: 14+9=23, UDP Data for IPv4: 14+20+8=42
+// The bursts of the received frames are classified by classifyBurst() (see classifier.h).
 int receive(void *par)
 {
   // collecting input parameters:
   class receiverParameters *p = (class receiverParameters *)par;
   uint64_t finish_receiving = p->finish_receiving;
   uint8_t eth_id = p->eth_id;
-  const char *direction = p->direction;
+  uint16_t queue_id = p->queue_id;
+  struct rxCounters *counters = p->counters;
 
   // further local variables
-  int frames, i;
+  int frames;
   struct rte_mbuf *pkt_mbufs[MAX_PKT_BURST];                      // pointers for the mbufs of received frames
-  uint16_t ipv4 = htons(0x0800);                                  // EtherType for IPv4 in Network Byte Order
-  uint16_t ipv6 = htons(0x86DD);                                  // EtherType for IPv6 in Network Byte Order
   uint8_t identify[8] = {'I', 'D', 'E', 'N', 'T', 'I', 'F', 'Y'}; // Identificion of the Test Frames
   uint64_t *id = (uint64_t *)identify;
+  RxMasks test;          // the Test Frames of the burst (see classifier.h)
   uint64_t received = 0; // number of received frames
 
   while (rte_rdtsc() < finish_receiving)
   {
-    frames = rte_eth_rx_burst(eth_id, 0, pkt_mbufs, MAX_PKT_BURST);
-    for (i = 0; i < frames; i++)
-    {
-      uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[i], uint8_t *); // Access the Test Frame in the message buffer
-      // check EtherType at offset 12: IPv6, IPv4, or anything else
-      if (*(uint16_t *)&pkt[12] == ipv6)
-      { /* IPv6 */
-        /* check if IPv6 Next Header is UDP, and the first 8 bytes of UDP data is 'IDENTIFY' */
-        if (likely(pkt[20] == 17 && *(uint64_t *)&pkt[62] == *id))
-          received++;
-      }
-      else if (*(uint16_t *)&pkt[12] == ipv4)
-      { /* IPv4 */
-         /* check if IPv4 Next Header is UDP, and the first 8 bytes of UDP data is 'IDENTIFY' */
-        if (likely(pkt[23] == 17 && *(uint64_t *)&pkt[42] == *id))
-          received++;
-      }
-      rte_pktmbuf_free(pkt_mbufs[i]);
-    }
+    frames = rte_eth_rx_burst(eth_id, queue_id, pkt_mbufs, MAX_PKT_BURST);
+    classifyBurst<1>(pkt_mbufs, frames, id, &test);
+    if (p->trial)
+      counters->stale += filterTrial(pkt_mbufs, &test, p->trial); // the frames of the earlier trials are not counted
+    received += __builtin_popcount(test.ipv6 | test.ipv4);
+    if (p->validator)
+      p->validator->check(pkt_mbufs, test, counters);
+    if (p->ce_stats)
+      p->ce_stats->count(pkt_mbufs, test, queue_id);
+    if (p->seq)
+      p->seq->track(pkt_mbufs, test);
+    freeBurst(pkt_mbufs, frames);
+    counters->received = received; // the counter is in the own cache line of the receiver
+  }
+  return 0;
+}
+
+// waits until the receivers of a direction finish, and returns the number of frames received by them together
+// It also reports, if the tester itself could not keep up with the incoming frames (the statistics of the port are reset
+// before the receivers start), and the result of the validation (if active).
+uint64_t waitReceivers(receiverParameters **rpars, const int *cpus, int num_of_receivers)
+{
+  uint64_t received = 0; // the number of frames received by all the receivers of the direction
+  uint64_t bad_src = 0, bad_dst = 0, bad_port = 0, untranslated = 0; // the mismatches found by the validator
+  uint64_t stale = 0; // the frames of the earlier trials of the binary search
+  struct rte_eth_stats stats;
+  for (int q = 0; q < num_of_receivers; q++)
+  {
+    rte_eal_wait_lcore(cpus[q]);
+    received += rpars[q]->counters->received;
+    bad_src += rpars[q]->counters->bad_src;
+    bad_dst += rpars[q]->counters->bad_dst;
+    bad_port += rpars[q]->counters->bad_port;
+    untranslated += rpars[q]->counters->untranslated;
+    stale += rpars[q]->counters->stale;
+  }
+  if (stale)
+    printf("Info: %s frames of earlier trials ignored: %lu\n", rpars[0]->direction, stale);
+  if (rte_eth_stats_get(rpars[0]->eth_id, &stats) == 0 && (stats.imissed || stats.rx_nombuf))
+    printf("Warning: %s receiving port dropped frames: imissed: %lu, rx_nombuf: %lu\n", rpars[0]->direction, stats.imissed, stats.rx_nombuf);
+  if (rpars[0]->validator)
+  {
+    if (bad_src || bad_dst || bad_port || untranslated)
+      printf("Warning: %s translation errors: bad source address: %lu, bad destination address: %lu, bad port: %lu, untranslated: %lu\n",
+             rpars[0]->direction, bad_src, bad_dst, bad_port, untranslated);
+    else
+      printf("Info: %s translation validated: no errors\n", rpars[0]->direction);
   }
-  printf("%s frames received: %lu\n", direction, received);
   return received;
 }
 
+// waits until the senders of a direction finish, and reports the number of frames sent by them together
+void waitSenders(senderParameters **spars, const int *cpus, int num_of_senders, const char *direction)
+{
+  uint64_t sent_frames = 0; // the number of frames sent by all the senders of the direction
+  for (int q = 0; q < num_of_senders; q++)
+  {
+    rte_eal_wait_lcore(cpus[q]);
+    sent_frames += spars[q]->sent_frames;
+  }
+  printf("%s frames sent: %lu\n", direction, sent_frames);
+}
+
 // performs throughput (or frame loss rate) measurement
 void Throughput::measure(uint16_t leftport, uint16_t rightport)
 {
   // set common parameters for senders
   senderCommonParameters scp(ipv6_frame_size, ipv4_frame_size, frame_rate, test_duration, n, m, hz, start_tsc,
                              num_of_CEs, num_of_port_sets, num_of_ports, &tester_left_ipv6, &tester_right_ipv4, &dmr_ipv6, &tester_right_ipv6,
-                             bg_sport_min, bg_sport_max, bg_dport_min, bg_dport_max
+                             bg_sport_min, bg_sport_max, bg_dport_min, bg_dport_max, tx_burst_size, tx_max_skew, frame_ring_mb,
+                             pacer_profile, pacer_burst, pacer_period, pacer_amplitude, sequence, trial
                              );
 
+  // the parameters must exist until the senders and receivers finish
+  senderParameters *left_spars[MAX_SENDERS], *right_spars[MAX_SENDERS];         // parameters of the senders
+  receiverParameters *right_rpars[MAX_RECEIVERS], *left_rpars[MAX_RECEIVERS]; // parameters of the receivers
+  SeqTracker *right_seq[MAX_RECEIVERS], *left_seq[MAX_RECEIVERS];              // sequence number trackers of the receivers (if active)
+  uint64_t frames_to_send = (uint64_t)test_duration * frame_rate;              // see send()
+
   if (forward)
   { // Left to right direction is active
     
-    // set individual parameters for the left sender
-    // Initialize the parameter class instance
-    senderParameters spars(&scp, pkt_pool_left_sender, leftport, "forward", fwCE, (ether_addr *)dut_left_mac, (ether_addr *)tester_left_mac, 
-                           fwd_var_sport, fwd_var_dport, fwd_dport_min, fwd_dport_max);
-
-    // start left sender
-    if (rte_eal_remote_launch(send, &spars, left_sender_cpu))
-      std::cout << "Error: could not start Left Sender." << std::endl;
+    // set individual parameters for the left senders, and start them
+    for (int q = 0; q < num_left_senders; q++)
+    {
+      left_spars[q] = new senderParameters(&scp, pkt_pool_left_sender[q], leftport, q, num_left_senders, "forward", &left_tx_counters[q], fwHotCE, fwOrder, (ether_addr *)dut_left_mac, (ether_addr *)tester_left_mac,
+                                           fwd_var_sport, fwd_var_dport, fwd_dport_min, fwd_dport_max, left_chksum_offload, left_frame_split,
+                                           left_num_of_templates);
+      if (rte_eal_remote_launch(send, left_spars[q], left_sender_cpus[q]))
+        std::cout << "Error: could not start Left Sender #" << q << "." << std::endl;
+    }
 
-    // set parameters for the right receiver
-    receiverParameters rpars(finish_receiving, rightport, "forward");
+    rte_eth_stats_reset(rightport); // the frames dropped by the receiving port are counted from here (see waitReceivers())
 
-    // start right receiver
-    if (rte_eal_remote_launch(receive, &rpars, right_receiver_cpu))
-      std::cout << "Error: could not start Right Receiver." << std::endl;
+    // set individual parameters for the right receivers, and start them
+    for (int q = 0; q < num_right_receivers; q++)
+    {
+      right_seq[q] = sequence ? new SeqTracker(frames_to_send, num_left_senders, rte_lcore_to_socket_id(right_receiver_cpus[q]), "forward") : NULL;
+      right_rpars[q] = new receiverParameters(finish_receiving, rightport, q, "forward", &right_rx_counters[q], fwValidator, fwCEStats, right_seq[q], trial);
+      if (rte_eal_remote_launch(receive, right_rpars[q], right_receiver_cpus[q]))
+        std::cout << "Error: could not start Right Receiver #" << q << "." << std::endl;
+    }
   }
 
   if (reverse)
   { // Right to Left direction is active
     
-    // set individual parameters for the right sender
-    // Initialize the parameter class instance
-    senderParameters spars(&scp, pkt_pool_right_sender, rightport, "reverse", rvCE, (ether_addr *)dut_right_mac, (ether_addr *)tester_right_mac,
-                           rev_var_sport, rev_var_dport, rev_sport_min, rev_sport_max);
-
-    // start right sender
-    if (rte_eal_remote_launch(send, &spars, right_sender_cpu))
-      std::cout << "Error: could not start Right Sender." << std::endl;
+    // set individual parameters for the right senders, and start them
+    for (int q = 0; q < num_right_senders; q++)
+    {
+      right_spars[q] = new senderParameters(&scp, pkt_pool_right_sender[q], rightport, q, num_right_senders, "reverse", &right_tx_counters[q], rvHotCE, rvOrder, (ether_addr *)dut_right_mac, (ether_addr *)tester_right_mac,
+                                            rev_var_sport, rev_var_dport, rev_sport_min, rev_sport_max, right_chksum_offload, right_frame_split,
+                                            right_num_of_templates);
+      if (rte_eal_remote_launch(send, right_spars[q], right_sender_cpus[q]))
+        std::cout << "Error: could not start Right Sender #" << q << "." << std::endl;
+    }
 
-    // set parameters for the left receiver
-    receiverParameters rpars(finish_receiving, leftport, "reverse");
+    rte_eth_stats_reset(leftport); // the frames dropped by the receiving port are counted from here (see waitReceivers())
 
-    // start left receiver
-    if (rte_eal_remote_launch(receive, &rpars, left_receiver_cpu))
-      std::cout << "Error: could not start Left Receiver." << std::endl;
+    // set individual parameters for the left receivers, and start them
+    for (int q = 0; q < num_left_receivers; q++)
+    {
+      left_seq[q] = sequence ? new SeqTracker(frames_to_send, num_right_senders, rte_lcore_to_socket_id(left_receiver_cpus[q]), "reverse") : NULL;
+      left_rpars[q] = new receiverParameters(finish_receiving, leftport, q, "reverse", &left_rx_counters[q], rvValidator, rvCEStats, left_seq[q], trial);
+      if (rte_eal_remote_launch(receive, left_rpars[q], left_receiver_cpus[q]))
+        std::cout << "Error: could not start Left Receiver #" << q << "." << std::endl;
+    }
   }
 
   std::cout << "Info: Testing started." << std::endl;
+  if (monitor_interval)
+    runMonitor();
 
   // wait until active senders and receivers finish
   if (forward)
   {
-    rte_eal_wait_lcore(left_sender_cpu);
-    rte_eal_wait_lcore(right_receiver_cpu);
+    waitSenders(left_spars, left_sender_cpus, num_left_senders, "forward");
+    fw_received = waitReceivers(right_rpars, right_receiver_cpus, num_right_receivers);
+    printf("forward frames received: %lu\n", fw_received);
+    if (sequence)
+      reportSeqResults(right_seq, num_right_receivers, "forward");
+    for (int q = 0; q < num_left_senders; q++)
+      delete left_spars[q];
+    for (int q = 0; q < num_right_receivers; q++)
+    {
+      delete right_rpars[q];
+      delete right_seq[q];
+    }
   }
   if (reverse)
   {
-    rte_eal_wait_lcore(right_sender_cpu);
-    rte_eal_wait_lcore(left_receiver_cpu);
+    waitSenders(right_spars, right_sender_cpus, num_right_senders, "reverse");
+    rv_received = waitReceivers(left_rpars, left_receiver_cpus, num_left_receivers);
+    printf("reverse frames received: %lu\n", rv_received);
+    if (sequence)
+      reportSeqResults(left_seq, num_left_receivers, "reverse");
+    for (int q = 0; q < num_right_senders; q++)
+      delete right_spars[q];
+    for (int q = 0; q < num_left_receivers; q++)
+    {
+      delete left_rpars[q];
+      delete left_seq[q];
+    }
   }
+  if (fwCEStats)
+    reportCEStats(fwCEStats, num_left_senders, left_frame_split, true, "forward");
+  if (rvCEStats)
+    reportCEStats(rvCEStats, num_right_senders, right_frame_split, true, "reverse");
+  std::cout << "Info: Test finished." << std::endl;
+  if (!search)
+    release();
+}
+
+// releases the CE arrays, and the tables of the validators and of the per-CE accounting
+void Throughput::release()
+{
   if (fwCE)
-    rte_free(fwCE); // release the CEs data memory at the forward sender
+    freeCETable("array", "forward"); // release the CEs data memory at the forward sender
   if (rvCE)
-    rte_free(rvCE); // release the CEs data memory at the reverse sender
-  if (fwUniqueEAComb) 
-    rte_free(fwUniqueEAComb);	// release the memory of the unique EA-bits combinations at the forward sender
-  if (rvUniqueEAComb) 
-    rte_free(rvUniqueEAComb);	// release the memory of the unique EA-bits combinations at the reverse sender
-  std::cout << "Info: Test finished." << std::endl;
+    freeCETable("array", "reverse"); // release the CEs data memory at the reverse sender
+  if (fwHotCE)
+    freeCETable("hot records", "forward"); // release the hot records of the CEs
+  if (rvHotCE)
+    freeCETable("hot records", "reverse");
+  delete fwOrder; // release the streams of the CE orders
+  delete rvOrder;
+  delete fwValidator; // release the expectation tables of the validators
+  delete rvValidator;
+  delete fwCEStats; // release the tables and counters of the per-CE accounting
+  delete rvCEStats;
+}
+
+// reports the per-CE statistics of a direction (see cestats.h)
+// ring: the senders of the direction replayed pre-rendered frames (maptperf-tp only), see send()
+void Throughput::reportCEStats(CEStats *stats, int num_of_senders, bool frame_split, bool ring, const char *direction)
+{
+  uint64_t frames_to_send = (uint64_t)test_duration * frame_rate; // see send()
+  uint64_t ring_size[MAX_SENDERS];                                // the size of the ring of each sender (0: no ring)
+  for (int q = 0; q < num_of_senders; q++)
+    ring_size[q] = ring ? frameRingSize(frame_ring_mb, ringFrameSize(ipv6_frame_size, frame_split), frame_split, n,
+                                        (frames_to_send + num_of_senders - 1 - q) / num_of_senders) : 0;
+  stats->countSent(frames_to_send, num_of_senders, ring_size, n, m);
+  stats->report(direction);
+}
+
+// samples the counters of the senders and receivers of the active directions until the end of receiving (see monitor.h)
+void Throughput::runMonitor()
+{
+  Monitor mon(monitor_interval, hz, start_tsc, finish_receiving);
+  if (forward)
+    mon.addDirection("forward", left_tx_counters, num_left_senders, right_rx_counters, num_right_receivers);
+  if (reverse)
+    mon.addDirection("reverse", right_tx_counters, num_right_senders, left_rx_counters, num_left_receivers);
+  mon.run();
+  mon.write();
 }
 
 // sets the values of the data fields
 senderCommonParameters::senderCommonParameters(uint16_t ipv6_frame_size_, uint16_t ipv4_frame_size_, uint32_t frame_rate_, uint16_t test_duration_,
                                                uint32_t n_, uint32_t m_, uint64_t hz_, uint64_t start_tsc_, uint32_t num_of_CEs_,
-                                               uint16_t num_of_port_sets_, uint16_t num_of_ports_, struct in6_addr *tester_l_ipv6_, uint32_t *tester_r_ipv4_,
+                                               uint32_t num_of_port_sets_, uint16_t num_of_ports_, struct in6_addr *tester_l_ipv6_, uint32_t *tester_r_ipv4_,
                                                struct in6_addr *dmr_ipv6_, struct in6_addr *tester_r_ipv6_,
-                                               uint16_t bg_sport_min_, uint16_t bg_sport_max_, uint16_t bg_dport_min_, uint16_t bg_dport_max_
-                                               )
+                                               uint16_t bg_sport_min_, uint16_t bg_sport_max_, uint16_t bg_dport_min_, uint16_t bg_dport_max_,
+                                               uint16_t tx_burst_size_, uint16_t tx_max_skew_, uint32_t frame_ring_mb_,
+                                               int pacer_profile_, uint16_t pacer_burst_, uint16_t pacer_period_, uint16_t pacer_amplitude_, bool sequence_,
+                                               uint16_t trial_)
 {
 
   ipv6_frame_size = ipv6_frame_size_;
@@ -1596,185 +1980,231 @@ senderCommonParameters::senderCommonParameters(uint16_t ipv6_frame_size_, uint16
   bg_sport_max = bg_sport_max_;
   bg_dport_min = bg_dport_min_;
   bg_dport_max = bg_dport_max_;
+  tx_burst_size = tx_burst_size_;
+  tx_max_skew = tx_max_skew_;
+  frame_ring_mb = frame_ring_mb_;
+  pacer_profile = pacer_profile_;
+  pacer_burst = pacer_burst_;
+  pacer_period = pacer_period_;
+  pacer_amplitude = pacer_amplitude_;
+  sequence = sequence_;
+  trial = trial_;
 }
 
 // sets the values of the data fields
-senderParameters::senderParameters(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, const char *direction_,
-                                   CE_data *CE_array_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
-                                   uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_
-                                   )
+senderParameters::senderParameters(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, uint16_t queue_id_, uint16_t num_of_queues_, const char *direction_,
+                                   struct txCounters *counters_, const void *hot_CEs_, const CEOrder *ce_order_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
+                                   uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_, bool chksum_offload_, bool frame_split_,
+                                   int num_of_templates_)
 {
   cp = cp_;
   pkt_pool = pkt_pool_;
   eth_id = eth_id_;
+  queue_id = queue_id_;
+  num_of_queues = num_of_queues_;
   direction = direction_;
-  CE_array = CE_array_;
+  counters = counters_;
+  hot_CEs = hot_CEs_;
+  ce_order = ce_order_;
   dst_mac = dst_mac_;
   src_mac = src_mac_;
   var_sport = var_sport_;
   var_dport = var_dport_;
   preconfigured_port_min = preconfigured_port_min_;
   preconfigured_port_max = preconfigured_port_max_;
+  chksum_offload = chksum_offload_;
+  frame_split = frame_split_;
+  num_of_templates = num_of_templates_;
+  sent_frames = 0;
+  counters->sent = 0;
 }
 
 // sets the values of the data fields
-receiverParameters::receiverParameters(uint64_t finish_receiving_, uint8_t eth_id_, const char *direction_)
+receiverParameters::receiverParameters(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                                       Validator *validator_, CEStats *ce_stats_, SeqTracker *seq_, uint16_t trial_)
 {
   finish_receiving = finish_receiving_;
   eth_id = eth_id_;
+  queue_id = queue_id_;
   direction = direction_;
+  counters = counters_;
+  validator = validator_;
+  ce_stats = ce_stats_;
+  seq = seq_;
+  trial = trial_;
+  counters->received = 0;
+  counters->bad_src = counters->bad_dst = counters->bad_port = counters->untranslated = 0;
+  counters->stale = 0;
 }
 
-// helper function to the generator function below
-void randomPermutation48(EAbits48 *array, uint8_t ip4_suffix_length, uint8_t psid_length){
-  uint32_t suffix_field, suffix_min, x; // x for suffix coordinate
-  uint16_t psid_field, psid_min, y; // y for psid coordinate
-  uint32_t xsize = pow(2.0,ip4_suffix_length);
-  uint32_t ysize = pow(2.0,psid_length); // 
-  uint64_t size = (xsize-2)*(ysize);  // size of the entire array / -2 to exclude all 0's case(subnet addr) and all 1's case(broadcast addr)
-  uint64_t index, random; 	// index and random variables
-
-  // prepare random permutation using Fisher–Yates shuffle, as implemented by Durstenfeld (in-place)
-  // http://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle#The_.22inside-out.22_algorithm
-
-  // random number infrastructure is taken from: https://en.cppreference.com/w/cpp/numeric/random/uniform_real_distribution
-  // MT64 is used because of https://medium.com/@odarbelaeze/how-competitive-are-c-standard-random-number-generators-f3de98d973f0
-  // thread_local is used on the basis of https://stackoverflow.com/questions/40655814/is-mersenne-twister-thread-safe-for-cpp
-  thread_local std::random_device rd;  // Will be used to obtain a seed for the random number engine
-  thread_local std::mt19937_64 gen(rd()); // Standard 64-bit mersenne_twister_engine seeded with rd()
-  std::uniform_real_distribution<double> uni_dis(0, 1.0);
-
-  // set the very first element
-  array[0].ip4_suffix = suffix_min = 1;
-  array[0].psid = psid_min = 0;
-  
-  for ( index=1; index<size; index++ ){
-    // prepare the coordinates
-    x = index / ysize;	// suffix field relative to suffix_min
-    y = index % ysize;	// psid field relative to psid_min
-    suffix_field = x + suffix_min;	// real suffix field
-    psid_field = y + psid_min;	// real psid field
-    // generate a random integer in the range [0, index] using uni_dis(gen), a random double in [0, 1).
-    random = uni_dis(gen)*(index+1);
-
-    // condition "if ( random != index )" is left out to spare a branch instruction on the cost of a redundant copy
-    array[index].ip4_suffix = array[random].ip4_suffix;
-    array[index].psid = array[random].psid;
-    array[random].ip4_suffix = suffix_field;
-    array[random].psid = psid_field;
-      
+// builds the CE arrays of the given directions concurrently, using all the lcores of the Tester (they are idle now)
+// Each lcore builds a slice of the array of the direction whose sender is in the same NUMA node as the lcore
+// (the lcores of the other nodes, or of a node shared by both directions, are assigned to the directions alternately).
+void Throughput::buildCEArrays(bool build_fw, bool build_rv)
+{
+  bool build[2] = {build_fw, build_rv};
+  CE_data **arrays[2] = {&fwCE, &rvCE};
+  int socket[2] = {SOCKET_ID_ANY, SOCKET_ID_ANY}; // the cores of the senders of an inactive direction are not set
+  if (build_fw)
+    socket[0] = rte_lcore_to_socket_id(left_sender_cpus[0]);
+  if (build_rv)
+    socket[1] = rte_lcore_to_socket_id(right_sender_cpus[0]);
+  const char *direction[2] = {"forward", "reverse"};
+  static int lcores[2][RTE_MAX_LCORE];                  // the lcores building the slices of the arrays
+  static CEArrayBuilderParameters pars[2][RTE_MAX_LCORE]; // the parameters of the slices
+  int num_lcores[2] = {0, 0};
+  int turn = 0;
+  unsigned lcore;
+  uint64_t start_gen, end_gen;
+
+  if (!build_fw && !build_rv)
+    return;
+  RTE_LCORE_FOREACH_SLAVE(lcore)
+  {
+    int s = rte_lcore_to_socket_id(lcore), d;
+    if (!build[1] || !build[0])
+      d = build[0] ? 0 : 1; // the socket of the other direction is not compared
+    else if (s == socket[0] && s != socket[1])
+      d = 0;
+    else if (s == socket[1] && s != socket[0])
+      d = 1;
+    else
+    {
+      d = turn;
+      turn ^= 1;
+    }
+    lcores[d][num_lcores[d]++] = lcore;
+  }
+  for (int d = 0; d < 2; d++)
+    if (build[d] && !num_lcores[d] && num_lcores[1 - d] > 1)
+      lcores[d][num_lcores[d]++] = lcores[1 - d][--num_lcores[1 - d]]; // every direction needs at least one lcore
+
+  // the per-rule constants of the slices: the BMR Rule IPv6 Prefix is the leftmost part of the end user IPv6 prefix
+  MapRule rule;
+  rule.rule_prefix = rte_be_to_cpu_64(*(uint64_t *)bmr_ipv6_prefix.s6_addr) >> (64 - bmr_ipv6_prefix_length);
+  rule.bmr_ipv4_prefix = bmr_ipv4_prefix;
+  rule.bmr_ipv4_suffix_length = bmr_ipv4_suffix_length;
+  rule.psid_length = psid_length;
+  EAPermutation *perms[2] = {NULL, NULL};
+  start_gen = rte_rdtsc();
+  for (int d = 0; d < 2; d++)
+  {
+    if (!build[d])
+      continue;
+    *arrays[d] = (CE_data *)reserveCETable("array", direction[d], (size_t)num_of_CEs * sizeof(CE_data), socket[d]);
+    if (!*arrays[d])
+      rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for CEs data at the %s sender!\n", direction[d]);
+  }
+  reserveHotCEs(); // they are written together with the CE arrays
+  for (int d = 0; d < 2; d++)
+  {
+    if (!build[d])
+      continue;
+    perms[d] = new EAPermutation(bmr_ipv4_suffix_length, psid_length, ce_seed, d); // shared by the slices
+    for (int k = 0; k < std::max(num_lcores[d], 1); k++)
+    {
+      CEArrayBuilderParameters *p = &pars[d][k];
+      p->CE = *arrays[d];
+      p->hot6 = d ? NULL : fwHotCE;
+      p->hot4 = d ? rvHotCE : NULL;
+      p->first = (uint64_t)num_of_CEs * k / std::max(num_lcores[d], 1);
+      p->last = (uint64_t)num_of_CEs * (k + 1) / std::max(num_lcores[d], 1);
+      p->perm = perms[d];
+      p->rule = &rule;
+      if (!num_lcores[d])
+        buildCEArray(p); // there is no other idle lcore, the main lcore builds it
+      else if (rte_eal_remote_launch(buildCEArray, p, lcores[d][k]))
+        rte_exit(EXIT_FAILURE, "Error: could not start buildCEArray() for pre-generating the array of CEs data at the %s sender\n", direction[d]);
+    }
   }
+  for (int d = 0; d < 2; d++)
+    for (int k = 0; k < num_lcores[d]; k++)
+      rte_eal_wait_lcore(lcores[d][k]);
+  end_gen = rte_rdtsc();
+  for (int d = 0; d < 2; d++)
+    if (build[d])
+    {
+      std::cout << "Info: building CE Array: Done. lasted " << 1.0 * (end_gen - start_gen) / rte_get_timer_hz() << " seconds for the " << direction[d]
+                << " sender (" << std::max(num_lcores[d], 1) << " lcores)\n";
+      delete perms[d];
+    }
+}
 
+// reserves a memzone for a CE table (a CE array or the hot records) of a direction on the given NUMA node, and reports its size
+// With tens of millions of CEs, the tables take gigabytes, thus 1GB hugepages are preferred (they need far fewer TLB entries),
+// but smaller ones are also accepted. Returns NULL, if there is not enough hugepage memory.
+void *reserveCETable(const char *table, const char *direction, size_t size, int socket_id)
+{
+  char name[RTE_MEMZONE_NAMESIZE];
+  snprintf(name, sizeof(name), "%s CE %s", direction, table);
+  const struct rte_memzone *mz = rte_memzone_reserve_aligned(name, size, socket_id, RTE_MEMZONE_1GB | RTE_MEMZONE_SIZE_HINT_ONLY, RTE_CACHE_LINE_SIZE);
+  if (!mz)
+    return NULL;
+  printf("Info: the CE %s of the %s sender: %.1lf MB in %lu MB hugepages on NUMA node %d\n", table, direction, size / 1048576.0, mz->hugepage_sz >> 20, mz->socket_id);
+  return mz->addr;
 }
 
-// creates an array of unique pseudorandom EA combinations
-int randomPermutationGenerator48(void *par) {
-  // collecting input parameters:
-  class randomPermutationGeneratorParameters48 *p = (class randomPermutationGeneratorParameters48 *)par;
-  uint8_t ip4_suffix_length = p->ip4_suffix_length;
-  uint8_t psid_length = p->psid_length;
-  uint64_t hz = p->hz;		// just for giving info about execution time
-  const char *direction = p->direction;
-  uint64_t start_gen, end_gen;  // timestamps for the above purpose 
-  EAbits48 *array= NULL;	// array for storing the unique EA combinations
-  uint64_t size = (pow(2.0,ip4_suffix_length)-2)*(pow(2.0,psid_length));  // size of the above array;
+// frees the memzone of a CE table reserved by reserveCETable()
+void freeCETable(const char *table, const char *direction)
+{
+  char name[RTE_MEMZONE_NAMESIZE];
+  snprintf(name, sizeof(name), "%s CE %s", direction, table);
+  const struct rte_memzone *mz = rte_memzone_lookup(name);
+  if (mz)
+    rte_memzone_free(mz);
+}
 
-  array = (EAbits48 *) rte_malloc("Pre-generated unique EA 48-bits combinations", (sizeof(EAbits48))*size, 128);
-  if ( !array )
-    rte_exit(EXIT_FAILURE, "Error: Can't allocate NUMA local memory for Pre-generated unique EA-bits combinations array for the %s sender!\n", direction);
-  
-  std::cout << "Info: Pre-generating NUMA local unique EA-bits combinations for the " << direction << " sender\n";
-  start_gen = rte_rdtsc();
-  randomPermutation48(array,ip4_suffix_length,psid_length);
-  end_gen = rte_rdtsc();
-  std::cout << "Done. lasted " << 1.0*(end_gen-start_gen)/hz << " seconds for the " << direction << " sender\n";
+// copies the fields used by the senders of the CEs [first, last) of a CE array into their hot records (hot6 or hot4 is NULL)
+void extractHotCEs(const CE_data *CE, CEHot6 *hot6, CEHot4 *hot4, uint32_t first, uint32_t last)
+{
+  for (uint32_t i = first; i < last; i++)
+    if (hot6)
+    {
+      hot6[i].map_addr = CE[i].map_addr;
+      hot6[i].map_addr_chksum = (uint16_t)CE[i].map_addr_chksum; // it is a 16-bit one's complement sum (see mapaddr.h)
+      hot6[i].psid = CE[i].psid;
+    }
+    else
+    {
+      hot4[i].ipv4_addr = CE[i].ipv4_addr;
+      hot4[i].ipv4_addr_chksum = CE[i].ipv4_addr_chksum;
+      hot4[i].psid = CE[i].psid;
+    }
+}
 
-  *(p->addr_of_arraypointer) = array;	// set the pointer in the caller
+// reserves the hot records of the senders of the directions with a CE array, in the memory of the senders
+void Throughput::reserveHotCEs()
+{
+  if (fwCE && !fwHotCE)
+  {
+    fwHotCE = (CEHot6 *)reserveCETable("hot records", "forward", (size_t)num_of_CEs * sizeof(CEHot6), rte_lcore_to_socket_id(left_sender_cpus[0]));
+    if (!fwHotCE)
+      rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the hot records of the CEs at the forward sender!\n");
+  }
+  if (rvCE && !rvHotCE)
+  {
+    rvHotCE = (CEHot4 *)reserveCETable("hot records", "reverse", (size_t)num_of_CEs * sizeof(CEHot4), rte_lcore_to_socket_id(right_sender_cpus[0]));
+    if (!rvHotCE)
+      rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for the hot records of the CEs at the reverse sender!\n");
+  }
 }
 
-// creates an array of the simulated CE elements
-int buildCEArray(void *par){
-// collecting input parameters
+// creates a slice of an array of the simulated CE elements
+// The EA-bits combinations are enumerated in batches, and the addresses of a batch are synthesized at once (see mapaddr.h).
+int buildCEArray(void *par)
+{
   class CEArrayBuilderParameters *p = (class CEArrayBuilderParameters *)par;
-  CE_data **addr_of_arraypointer= NULL;	
-  EAbits48 *UniqueEAComb = p->UniqueEAComb;       
-  uint8_t bmr_ipv4_suffix_length = p->bmr_ipv4_suffix_length; 
-  uint8_t psid_length = p->psid_length;            
-  uint32_t num_of_CEs = p->num_of_CEs;             
-  struct in6_addr bmr_ipv6_prefix = p->bmr_ipv6_prefix; 
-  uint8_t bmr_ipv6_prefix_length = p->bmr_ipv6_prefix_length;  
-  uint32_t bmr_ipv4_prefix = p->bmr_ipv4_prefix;        
-  uint64_t hz = p->hz; // just for giving info about execution time
-  const char *direction = p->direction; 
-  uint64_t start_gen, end_gen;  // timestamps for the above purpose 
-
-  if (!UniqueEAComb)
-    rte_exit(EXIT_FAILURE, "buildCEArray(): a NULL pointer to the array of pre-prepaired unique EA-bits combinations at the %s sender!\n", direction);
-	// unique pseudorandom EA-bits pairs are supplied by the pre-prepaired random permutation
-  
-  // some local variables
-  EAbits48 *uniqueEA = UniqueEAComb; // a working pointer to the current element of uniqueEAComb
-  uint64_t uniqueEAsize = (pow(2.0,bmr_ipv4_suffix_length)-2)*(pow(2.0,psid_length)); // The size of the uniqueEAComb array (i.e., no. of elements)
-  CE_data *CE = NULL;             // a pointer to the currently simulated CE's data.
-  uint32_t bmr_ipv4_suffix;       // The pseudorandomly selected ipv4 suffix for the simulated CE
-  uint64_t end_user_ipv6_prefix = 0; // The leftmost part of the MAP address
-  uint64_t interface_id = 0;       // The rightmost part of the MAP address
-  uint32_t map_addr_chksum = 0;   // The checksum of the MAP address to be added later to the UDP checksum of the sent packet
-  uint8_t bmr_ipv6_prefix_bytes;  // The number of bytes allocated to the bmr_ipv6_prefix in the map address
-  uint8_t bmr_ipv6_prefix_bits;   // The number of bits in the last byte fragment needed to complete the bmr_ipv6_prefix in the map address
-
-  bmr_ipv6_prefix_bytes = bmr_ipv6_prefix_length / 8;
-  bmr_ipv6_prefix_bits = bmr_ipv6_prefix_length % 8;
-
-  CE = (CE_data *)rte_malloc("CEs data memory", num_of_CEs * sizeof(CE_data), 0);
-  if (!CE)
-    rte_exit(EXIT_FAILURE, "malloc failure!! Can not allocate memory for CEs data at the %s sender!\n", direction);
-
-  start_gen = rte_rdtsc();
-  for (int curr = 0; curr < num_of_CEs; curr++)
-  {
-    // resetting checksums
-    CE[curr].ipv4_addr_chksum = 0;
-    CE[curr].map_addr_chksum = 0;
-
-    // Assign the current pseudorandomly enumerated EA fields 
-    bmr_ipv4_suffix = uniqueEA->ip4_suffix;
-    CE[curr].psid = uniqueEA->psid;
-
-    // step to the next EA combination
-    uniqueEA++;
-
-    // Generating the map address
-    for (int i = 0; i < bmr_ipv6_prefix_bytes; i++)
-      end_user_ipv6_prefix = (end_user_ipv6_prefix << 8) | bmr_ipv6_prefix.s6_addr[i];
-   
-    if (bmr_ipv6_prefix_bits)
-      end_user_ipv6_prefix = (end_user_ipv6_prefix << bmr_ipv6_prefix_bits) | (bmr_ipv6_prefix.s6_addr[bmr_ipv6_prefix_bytes] >> (8 - bmr_ipv6_prefix_bits));
-   
-    end_user_ipv6_prefix = (end_user_ipv6_prefix << bmr_ipv4_suffix_length) | bmr_ipv4_suffix;
-    end_user_ipv6_prefix = (end_user_ipv6_prefix << psid_length) | CE[curr].psid;
-    CE[curr].ipv4_addr = bmr_ipv4_prefix | htonl(bmr_ipv4_suffix);
-    CE[curr].ipv4_addr_chksum = rte_raw_cksum(&CE[curr].ipv4_addr, 4); //calculate the IPv4 header checksum
-    interface_id = interface_id | ntohl(CE[curr].ipv4_addr);
-    interface_id = interface_id << 16 | CE[curr].psid;
-    CE[curr].map_addr = concatenate(end_user_ipv6_prefix, interface_id);
-    
-    for (int j = 0; j < 16; j = j + 2) // calculate the MAP address checksum that will be added to the UDP checksum later
-      map_addr_chksum += ((CE[curr].map_addr.s6_addr[j + 1] & 0x00ff) << 8) | CE[curr].map_addr.s6_addr[j];
+  EAbits48 ea[MAPADDR_BATCH]; // the pseudorandomly enumerated EA-bits combinations of the current batch (see eaperm.h)
 
-    map_addr_chksum = ((map_addr_chksum & 0xffff0000) >> 16) + (map_addr_chksum & 0xffff); // add any carry to the final result
-    map_addr_chksum = ((map_addr_chksum & 0xffff0000) >> 16) + (map_addr_chksum & 0xffff); // Twice is enough
-    CE[curr].map_addr_chksum = map_addr_chksum;
-
-    // reset some variables for the next cycle
-    end_user_ipv6_prefix = 0;
-    interface_id = 0;
-    map_addr_chksum = 0;
+  for (uint32_t curr = p->first; curr < p->last; curr += MAPADDR_BATCH)
+  {
+    uint32_t n = std::min(p->last - curr, (uint32_t)MAPADDR_BATCH);
+    for (uint32_t i = 0; i < n; i++)
+      ea[i] = p->perm->get(curr + i);
+    synthesizeCEs(p->CE + curr, ea, n, p->rule);
+    extractHotCEs(p->CE, p->hot6, p->hot4, curr, curr + n); // while the batch is in the cache
   }
-  
-   end_gen = rte_rdtsc();
-    std::cout << "Info: building CE Array: Done. lasted " << 1.0*(end_gen-start_gen)/hz << " seconds for the " << direction << " sender\n";
-  *(p->addr_of_arraypointer) = CE;	// set the pointer in the caller
+  return 0;
 }
 
 
@@ -22,7 +22,7 @@
 #define THROUGHPUT_H_INCLUDED
 
 
-// used for generating EA-bits (ipv4 suffix and psid) combinations using random permutation
+// an EA-bits (ipv4 suffix and psid) combination, see eaperm.h
 struct EAbits48{
   uint32_t ip4_suffix;	// The Ipv4 suffix
   uint16_t psid;	// The port set id
@@ -50,6 +50,48 @@ public:
   uint16_t psid; // The ID of the randomly selected port set for the simulated CE
 };
 
+// the hot records of the CEs: the fields of CE_data used by the senders (see extractHotCEs())
+// A forward sender uses only the MAP address and a reverse sender only the IPv4 address of a CE (with its checksum and the PSID),
+// thus each direction has its own array of packed records (20 or 8 bytes instead of the 32 bytes of CE_data).
+struct CEHot6
+{
+  struct in6_addr map_addr;
+  uint16_t map_addr_chksum;
+  uint16_t psid;
+};
+
+struct CEHot4
+{
+  uint32_t ipv4_addr;
+  uint16_t ipv4_addr_chksum;
+  uint16_t psid;
+};
+
+// the counters of a Receiver, written only by the Receiver itself and read after the end of receiving
+// Each of them occupies a separate cache line, so the Receivers of a direction do not disturb each other.
+struct rxCounters
+{
+  uint64_t received;     // number of received Test Frames
+  uint64_t bad_src;      // number of Test Frames with an unexpected source address (if validation is active, see validator.h)
+  uint64_t bad_dst;      // number of Test Frames with an unexpected destination address
+  uint64_t bad_port;     // number of Test Frames with a port outside of the port set of their CE
+  uint64_t untranslated; // number of Test Frames arriving with the IP version they were sent
+  uint64_t stale;        // number of Test Frames of an earlier trial of the in-process binary search (not counted as received, see search.h)
+} __rte_cache_aligned;
+
+// the counters of a Sender, written only by the Sender itself, and sampled by the monitor during sending (see monitor.h)
+struct txCounters
+{
+  uint64_t sent; // number of frames handed over to the NIC so far
+} __rte_cache_aligned;
+
+class Validator; // see validator.h
+class CEStats;   // see cestats.h
+class SeqTracker; // see sequence.h
+class EAPermutation; // see eaperm.h
+struct MapRule;      // see mapaddr.h
+class CEOrder;       // see ceorder.h
+
 // the main class for maptperf
 // data members are used for storing parameters
 // member functions are used for the most important functions
@@ -92,15 +134,48 @@ public:
   struct in6_addr dmr_ipv6_prefix; // The IPv6 prefix that will be added by DMR to the public IPv4 address
   uint8_t dmr_ipv6_prefix_length;  // The DMR's IPv6 prefix length : should be between 64 and 96 bits according to RFC 7599
 
-  int left_sender_cpu;    // lcore for left side Sender
-  int right_receiver_cpu; // lcore for right side Receiver
-  int right_sender_cpu;   // lcore for right side Sender
-  int left_receiver_cpu;  // lcore for left side Receiver
+  int left_sender_cpus[MAX_SENDERS];  // lcores for left side Senders (each of them uses its own TX queue)
+  int num_left_senders;               // number of left side Senders
+  int right_receiver_cpus[MAX_RECEIVERS]; // lcores for right side Receivers (each of them polls its own RX queue)
+  int num_right_receivers;                // number of right side Receivers
+  int right_sender_cpus[MAX_SENDERS]; // lcores for right side Senders (each of them uses its own TX queue)
+  int num_right_senders;              // number of right side Senders
+  int left_receiver_cpus[MAX_RECEIVERS];  // lcores for left side Receivers (each of them polls its own RX queue)
+  int num_left_receivers;                 // number of left side Receivers
 
   uint8_t memory_channels; // Number of memory channnels (for the EAL init.)
   int forward, reverse;    // directions are active if set
   int promisc;             // promiscuous mode is active if set
 
+  // transmission parameters
+  uint16_t tx_burst_size; // maximum number of frames handed over to the NIC in a single rte_eth_tx_burst() call (1: precision mode)
+  uint16_t tx_max_skew;   // maximum tolerated time (in microseconds) by which the last frame of a burst may be sent earlier than due
+  uint32_t frame_ring_mb; // memory budget (in MB) for the ring of pre-rendered frames used by the throughput sender (0: frames are patched while sending)
+  int tx_chksum_offload;  // the IPv4 header and UDP checksums are to be calculated by the NIC, if it supports it (0: inactive, 1: active)
+  int frame_split;        // the frames are header + shared payload segment chains, if the NIC supports it (0: inactive, 1: active)
+  int pacer_profile;      // arrival profile of the frames (0: CBR, 1: Poisson, 2: on/off microbursts, 3: sinusoidal, see pacer.h)
+  uint16_t pacer_burst;   // number of frames in a microburst of the on/off profile
+  uint16_t pacer_period;  // period (in milliseconds) of the sinusoidal profile
+  uint16_t pacer_amplitude; // amplitude (in percent of the frame rate) of the sinusoidal profile
+  int validate;             // the translation of the received Test Frames is checked (0: inactive, 1: active, see validator.h)
+  int ce_stats;             // the received Test Frames are counted per CE (0: inactive, 1: active, see cestats.h)
+  int sequence;             // the Test Frames carry sequence numbers, which are analysed by the receivers (0: inactive, 1: active, see sequence.h)
+  int hw_timestamp;         // the latency and PDV timestamps are taken by the NICs, if they support it (0: inactive, 1: active, see timestamp.h)
+  int latency_histogram;    // every foreground frame is timestamped, maptperf-lat only (0: inactive, 1: active, see hdrhist.h)
+  uint32_t monitor_interval; // the sampling interval of the live traffic monitor (in milliseconds, 0: inactive, see monitor.h)
+  int search;               // in-process binary search for the throughput, maptperf-tp only (0: inactive, 1: active, see search.h)
+  uint32_t search_low;      // the lower bound of the binary search (the upper bound is the frame rate given in the command line)
+  uint32_t search_error;    // the search stops, when the difference of the bounds is not more than this
+  int search_experiments;   // the number of the binary searches
+  double search_loss;       // the tolerated frame loss in each direction (in percent of the frames sent)
+  int search_sleep;         // the sleeping time between the trials (in seconds)
+  uint64_t ce_seed;         // the seed of the pseudorandom permutation of the EA-bits combinations (0: random seed)
+  char ce_cache[LINELEN + 1]; // the directory of the persistent cache of the CE arrays (empty: inactive, see cecache.h)
+  int ce_order;             // the order of the CEs visited by the foreground frames (CE_ORDER_SEQUENTIAL, etc., see ceorder.h)
+  double ce_skew;           // the exponent of the Zipf order
+  double ce_hot_ces;        // the hot set order: the percent of the CEs in the hot set
+  double ce_hot_load;       // the hot set order: the percent of the frames belonging to the hot set
+
   // positional parameters from command line
   uint16_t ipv6_frame_size; // size of the frames carrying IPv6 datagrams (including the 4 bytes of the FCS at the end)
   uint16_t ipv4_frame_size; // redundant parameter, automatically set as ipv6_frame_size-20
@@ -110,20 +185,38 @@ public:
   uint32_t n, m;            // modulo and threshold for controlling background traffic proportion
 
   // further data members, set by init()
-  rte_mempool *pkt_pool_left_sender, *pkt_pool_right_receiver; // packet pools for the forward direction testing
-  rte_mempool *pkt_pool_right_sender, *pkt_pool_left_receiver; // packet pools for the reverse direction testing
+  rte_mempool *pkt_pool_left_sender[MAX_SENDERS], *pkt_pool_right_receiver[MAX_RECEIVERS]; // packet pools for the forward direction testing (one per Sender/Receiver)
+  rte_mempool *pkt_pool_right_sender[MAX_SENDERS], *pkt_pool_left_receiver[MAX_RECEIVERS]; // packet pools for the reverse direction testing (one per Sender/Receiver)
   uint64_t hz;                                                 // number of clock cycles per second
   uint64_t start_tsc;                                          // sending of the test frames will begin at this time
   uint64_t finish_receiving;                                   // receiving of the test frames will end at this time
+  struct rxCounters right_rx_counters[MAX_RECEIVERS];          // counters of the right side Receivers (forward direction)
+  struct rxCounters left_rx_counters[MAX_RECEIVERS];           // counters of the left side Receivers (reverse direction)
+  struct txCounters left_tx_counters[MAX_SENDERS];             // counters of the left side Senders (forward direction)
+  struct txCounters right_tx_counters[MAX_SENDERS];            // counters of the right side Senders (reverse direction)
+  bool left_chksum_offload, right_chksum_offload;              // checksum offload is requested and also supported by the port
+  bool left_frame_split, right_frame_split;                    // frame split is requested and the port supports multi-segment frames
+  bool left_hw_rx_ts, right_hw_rx_ts;                          // hardware RX timestamps are requested and supported by the port
+  bool left_hw_tx_ts, right_hw_tx_ts;                          // hardware TX timestamps are requested and supported by the port
+  uint16_t left_tx_ring_size, right_tx_ring_size;              // number of the descriptors of the TX queues of the port
+  int left_num_of_templates, right_num_of_templates;           // number of the template frames of each kind of the senders of the port
   uint64_t frames_to_send;                                     // number of frames to send
+  uint16_t trial;                                              // the ID of the current trial of the binary search (0: no search)
+  uint64_t fw_received, rv_received;                           // number of frames received in the last test by the active directions
 
-  EAbits48 *fwUniqueEAComb;       // array of pre-generated unique EA-bits (ipv4 suffix and psid) combinations, to be used by the forward sender
-  EAbits48 *rvUniqueEAComb;       // same as above, but for the reverse sender
   CE_data *fwCE;                  // a pointer to the currently simulated CE's data in the forward direction.
   CE_data *rvCE;                  // a pointer to the currently simulated CE's data in the reverse direction.
+  CEHot6 *fwHotCE;                // the hot records of the CEs used by the forward senders
+  CEHot4 *rvHotCE;                // the hot records of the CEs used by the reverse senders
+  CEOrder *fwOrder;               // the order of the CEs in the forward direction (NULL in the sequential order)
+  CEOrder *rvOrder;               // the order of the CEs in the reverse direction (NULL in the sequential order)
+  Validator *fwValidator;         // the translation validator of the right side Receivers (NULL, if validation is inactive)
+  Validator *rvValidator;         // the translation validator of the left side Receivers (NULL, if validation is inactive)
+  CEStats *fwCEStats;             // the per-CE accounting of the right side Receivers (NULL, if it is inactive)
+  CEStats *rvCEStats;             // the per-CE accounting of the left side Receivers (NULL, if it is inactive)
   uint8_t bmr_ipv4_suffix_length; // The BMR's IPv4 suffix length
   uint8_t psid_length;            // The number of BMR's PSID bits
-  uint16_t num_of_port_sets;      // The number of port sets that can be obtained according to the psid_length
+  uint32_t num_of_port_sets;      // The number of port sets that can be obtained according to the psid_length
   uint16_t num_of_ports;          // The number of ports in each port set
   //uint32_t num_of_suffixes;       // The total number of ipv4 suffixes that can be obtained according to bmr_ipv4_suffix_length
   //uint32_t bmr_ipv4_suffix;       // The randomly selected ipv4 suffix for the simulated CE
@@ -134,15 +227,24 @@ public:
 
   // helper functions (see their description at their definition)
   int findKey(const char *line, const char *key);
+  int readCpuList(const char *line, int *cpus, int max_cpus, const char *key);
+  int configurePort(uint16_t port, int num_rx_queues, int num_tx_queues, const char *port_side, bool *chksum_offload, bool *frame_split, bool *hw_rx_ts, uint16_t *tx_ring_size);
+  void enableTimesync(uint16_t port, const char *port_side, bool *hw_rx_ts, bool *hw_tx_ts);
   int readConfigFile(const char *filename);
   int readCmdLine(int argc, const char *argv[]);
   int init(const char *argv0, uint16_t leftport, uint16_t rightport);
-  virtual int senderPoolSize();
+  virtual int senderPoolSize(int num_of_templates);
   void numaCheck(uint16_t port, const char *port_side, int cpu, const char *cpu_name);
+  void reportCEStats(CEStats *stats, int num_of_senders, bool frame_split, bool ring, const char *direction);
+  void runMonitor();
   //void buildMapArray();
 
   // perform throughput measurement
   void measure(uint16_t leftport, uint16_t rightport);
+  void release(); // releases the CE arrays and the tables of the test
+  void buildCEArrays(bool build_fw, bool build_rv);
+  void reserveHotCEs();
+  void binarySearch(uint16_t leftport, uint16_t rightport); // see search.h
 
   Throughput();
 };
@@ -169,12 +271,44 @@ void check_tsc(int cpu, const char *cpu_name);
 // send test frame
 int send(void *par);
 
+// calculates the size of a pre-rendered frame in the ring (only the header segment is pre-rendered in frame split mode)
+uint16_t ringFrameSize(uint16_t ipv6_frame_size, bool frame_split);
+
+// calculates the number of frames fitting into the memory budget of the ring of pre-rendered frames
+uint64_t frameRingSize(uint32_t frame_ring_mb, uint16_t frame_size, bool frame_split, uint32_t n, uint64_t frames_to_send);
+
+// frees the pre-rendered frame ring of a sender and its packet pool after the replay
+void freeFrameRing(struct rte_mbuf **ring, uint64_t ring_size, rte_mempool *ring_pool, uint8_t eth_id, uint16_t queue_id, const char *direction);
+
+// calculates how many frames may be sent in a single burst without exceeding the tolerated skew
+uint16_t burstLimit(uint16_t tx_burst_size, uint16_t tx_max_skew, uint32_t frame_rate, uint16_t num_of_queues);
+
+// calculates the number of template frames of each kind, which ensures that no template frame is updated while the NIC still owns it
+int templateCount(uint16_t tx_ring_size, uint16_t tx_burst_size);
+
+// waits until the first frame of the burst is due, and then hands over all the frames of the burst to the NIC
+// It is inline, because it is called from the sending cycle of every sender.
+inline void sendBurst(uint8_t eth_id, uint16_t queue_id, struct rte_mbuf **burst, uint16_t count, uint64_t due_tsc)
+{
+  uint16_t sent = 0; // number of frames already accepted by the NIC
+  while (rte_rdtsc() < due_tsc)
+    ; // Beware: an "empty" loop
+  while (sent < count)
+    sent += rte_eth_tx_burst(eth_id, queue_id, burst + sent, count - sent);
+}
+
 // receive and count test frames
 int receive(void *par);
 
-// concatenate two uint64_t values to form an IPv6 address
-// It is used to concatenate the end user IPv6 prefix and the interface ID to form the MAP address
-struct in6_addr concatenate(uint64_t in1, uint64_t in2);
+// waits until the receivers of a direction finish, and returns the number of frames received by them together
+uint64_t waitReceivers(class receiverParameters **rpars, const int *cpus, int num_of_receivers);
+
+// waits until the senders of a direction finish, and reports the number of frames sent by them together
+void waitSenders(class senderParameters **spars, const int *cpus, int num_of_senders, const char *direction);
+
+// reserves the memory of a CE table (table: "array" or "hot records") of a direction in hugepages, and frees it
+void *reserveCETable(const char *table, const char *direction, size_t size, int socket_id);
+void freeCETable(const char *table, const char *direction);
 
 // to store identical parameters for both senders
 class senderCommonParameters
@@ -189,7 +323,7 @@ public:
   uint64_t start_tsc;       
   uint64_t frames_to_send;  
   uint32_t num_of_CEs;
-  uint16_t num_of_port_sets;
+  uint32_t num_of_port_sets;
   uint16_t num_of_ports;
   struct in6_addr *tester_l_ipv6;
   uint32_t *tester_r_ipv4;
@@ -199,73 +333,83 @@ public:
   uint16_t bg_dport_max; 
   uint16_t bg_sport_min; 
   uint16_t bg_sport_max;
+  uint16_t tx_burst_size;
+  uint16_t tx_max_skew;
+  uint32_t frame_ring_mb;
+  int pacer_profile;
+  uint16_t pacer_burst;
+  uint16_t pacer_period;
+  uint16_t pacer_amplitude;
+  bool sequence; // the frames carry their ordinal numbers as sequence numbers (maptperf-tp only)
+  uint16_t trial; // the ID of the trial of the binary search carried by the frames (0: no search, see search.h)
 
   senderCommonParameters(uint16_t ipv6_frame_size_, uint16_t ipv4_frame_size_, uint32_t frame_rate_, uint16_t test_duration_,
-                         uint32_t n_, uint32_t m_, uint64_t hz_, uint64_t start_tsc_, uint32_t num_of_CEs_, uint16_t num_of_port_sets_,
+                         uint32_t n_, uint32_t m_, uint64_t hz_, uint64_t start_tsc_, uint32_t num_of_CEs_, uint32_t num_of_port_sets_,
                          uint16_t num_of_ports_, struct in6_addr *tester_l_ipv6_, uint32_t *tester_r_ipv4_, struct in6_addr *dmr_ipv6_, 
-                         struct in6_addr *tester_r_ipv6_, uint16_t bg_sport_min_, uint16_t bg_sport_max_, uint16_t bg_dport_min_, uint16_t bg_dport_max_
-                         );
+                         struct in6_addr *tester_r_ipv6_, uint16_t bg_sport_min_, uint16_t bg_sport_max_, uint16_t bg_dport_min_, uint16_t bg_dport_max_,
+                         uint16_t tx_burst_size_, uint16_t tx_max_skew_, uint32_t frame_ring_mb_,
+                         int pacer_profile_, uint16_t pacer_burst_, uint16_t pacer_period_, uint16_t pacer_amplitude_, bool sequence_,
+                         uint16_t trial_);
 };
 
 // to store the distinct parameters of each sender + a pointer to the common ones
+// A direction may have several senders: the one with queue_id k sends the frames k, k+num_of_queues, k+2*num_of_queues, ...
 class senderParameters
 {
 public:
   class senderCommonParameters *cp; // a pointer to the common parameters
   rte_mempool *pkt_pool; // sender's packet pool
   uint8_t eth_id; // ethernet ID
+  uint16_t queue_id; // TX queue of the sender, and also its slice of the frames
+  uint16_t num_of_queues; // number of senders (and TX queues) of the direction
   const char *direction; // test direction (forward or reverse)
-  CE_data *CE_array;
+  struct txCounters *counters; // the sender's own counters, sampled by the monitor (see monitor.h)
+  const void *hot_CEs; // the hot records of the CEs of the direction: CEHot6 (forward) or CEHot4 (reverse)
+  const CEOrder *ce_order; // the order of the CEs of the direction (NULL in the sequential order, see ceorder.h)
   struct ether_addr *dst_mac, *src_mac; // destination and source mac addresses
   unsigned var_sport, var_dport; // how source and destination port numbers vary? 1:increase, 2:decrease, or 3:pseudorandomly change
   uint16_t preconfigured_port_min, preconfigured_port_max; // The preconfigured range of ports (i.e., destination in case of forward and source in case of reverse)
+  bool chksum_offload; // the IPv4 header and UDP checksums of the frames are calculated by the NIC
+  bool frame_split; // the frames consist of a header segment and a segment of the shared payload
+  int num_of_templates; // number of the template frames of each kind (see templateCount())
+  uint64_t sent_frames; // set by the sender: the number of frames it has sent
   
-  senderParameters(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, const char *direction_,
-                   CE_data *CE_array_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
-                   uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_
-                   );
+  senderParameters(class senderCommonParameters *cp_, rte_mempool *pkt_pool_, uint8_t eth_id_, uint16_t queue_id_, uint16_t num_of_queues_, const char *direction_,
+                   struct txCounters *counters_, const void *hot_CEs_, const CEOrder *ce_order_, struct ether_addr *dst_mac_, struct ether_addr *src_mac_, unsigned var_sport_, unsigned var_dport_,
+                   uint16_t preconfigured_port_min_, uint16_t preconfigured_port_max_, bool chksum_offload_, bool frame_split_,
+                   int num_of_templates_);
 };
 
 // to store parameters for each receiver
+// A direction may have several receivers: RSS distributes the frames among their RX queues.
 class receiverParameters
 {
 public:
   uint64_t finish_receiving; // this one is common, but it was not worth dealing with it.
   uint8_t eth_id;
+  uint16_t queue_id; // RX queue of the receiver
   const char *direction;
-  receiverParameters(uint64_t finish_receiving_, uint8_t eth_id_, const char *direction_);
+  struct rxCounters *counters; // the receiver's own counters, summed up by waitReceivers()
+  Validator *validator;        // the translation validator of the direction (NULL, if validation is inactive)
+  CEStats *ce_stats;           // the per-CE accounting of the direction (NULL, if it is inactive)
+  SeqTracker *seq;             // the sequence number tracker of the receiver (NULL, if it is inactive)
+  uint16_t trial;              // the ID of the current trial of the binary search (0: no search, see search.h)
+  receiverParameters(uint64_t finish_receiving_, uint8_t eth_id_, uint16_t queue_id_, const char *direction_, struct rxCounters *counters_,
+                     Validator *validator_, CEStats *ce_stats_, SeqTracker *seq_, uint16_t trial_);
 };
 
 
-void randomPermutation48(EAbits48 *array, uint8_t ip4_suffix_length, uint8_t psid_length);
-
-int randomPermutationGenerator48(void *par);
-
-// to store the parameters for randomPermutationGenerator48
-class randomPermutationGeneratorParameters48 {
-  public:
-  EAbits48 **addr_of_arraypointer;	// pointer to the place, where the pointer is stored 
-  uint8_t ip4_suffix_length;
-  uint8_t psid_length;
-  uint64_t hz;			// just to be able to display the execution time
-  const char *direction; // test direction (forward or reverse). To be used for showing for which sender this EA combinations array belongs.
-
-};
-
 int buildCEArray(void *par);
-//
+void extractHotCEs(const CE_data *CE, CEHot6 *hot6, CEHot4 *hot4, uint32_t first, uint32_t last);
+// the parameters of a slice of a CE array, built by an lcore (see Throughput::buildCEArrays())
 class CEArrayBuilderParameters{
   public:
-  CE_data **addr_of_arraypointer;	// pointer to the place, where the pointer is stored
-  EAbits48 *UniqueEAComb;       // array of pre-generated unique EA-bits (ipv4 suffix and psid) combinations, to be used by the relative sender
-  uint8_t bmr_ipv4_suffix_length; // The BMR's IPv4 suffix length
-  uint8_t psid_length;            // The number of BMR's PSID bits
-  uint32_t num_of_CEs;             // Number of simulated CEs
-  struct in6_addr bmr_ipv6_prefix; // The BMR’s Rule IPv6 Prefix of the MAP address
-  uint8_t bmr_ipv6_prefix_length;  // The BMR's Rule IPv6 Prefix length
-  uint32_t bmr_ipv4_prefix;        // The BMR’s public IPv4 prefix that is reserved for CEs in the MAP domain
-  uint64_t hz;			// just to be able to display the execution time
-  const char *direction; // test direction (forward or reverse). To be used for showing for which sender this CE array belongs.
+  CE_data *CE;                     // the CE array
+  CEHot6 *hot6;                    // the hot records of the CEs (forward direction only)
+  CEHot4 *hot4;                    // the hot records of the CEs (reverse direction only)
+  uint32_t first, last;            // the slice [first, last) of the array built by the lcore
+  EAPermutation *perm;             // the pseudorandom enumeration of the EA-bits combinations of the direction (see eaperm.h)
+  const MapRule *rule;             // the constants of the BMR (see mapaddr.h)
 };
 
 
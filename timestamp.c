@@ -0,0 +1,84 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "timestamp.h"
+
+HwClock::HwClock(uint16_t port_, uint64_t hz_)
+{
+  port = port_;
+  hz = hz_;
+  num_points = 0;
+}
+
+// reads the clock of the port HW_TS_SAMPLES times, and stores the fastest reading as the next calibration point
+void HwClock::calibrate()
+{
+  struct timespec ts;
+  uint64_t before, after, best = UINT64_MAX;
+  if (num_points == 2)
+    rte_exit(EXIT_FAILURE, "Error: the clock of port #%u has already been calibrated!\n", port);
+  for (int i = 0; i < HW_TS_SAMPLES; i++)
+  {
+    before = rte_rdtsc();
+    if (rte_eth_timesync_read_time(port, &ts))
+      rte_exit(EXIT_FAILURE, "Error: can not read the IEEE 1588 clock of port #%u!\n", port);
+    after = rte_rdtsc();
+    if (after - before < best)
+    {
+      best = after - before;
+      tsc[num_points] = before + best / 2;
+      ns[num_points] = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+  }
+  num_points++;
+}
+
+// replaces the software timestamps (in TSC) with the hardware timestamps (in nanoseconds) converted into the TSC domain
+// A timestamp is replaced only if both of them are present (non-zero) and they are close enough (see HW_TS_MAX_DIFF).
+// kind: "TX" or "RX", only for the report of the number of the software timestamps kept
+void HwClock::convert(uint64_t *ts, const uint64_t *hw_ts, uint64_t num_timestamps, const char *kind, const char *direction)
+{
+  uint64_t kept = 0;
+  int64_t max_diff = hz * HW_TS_MAX_DIFF / 1000000;
+  if (num_points != 2 || ns[1] == ns[0])
+    rte_exit(EXIT_FAILURE, "Error: the clock of port #%u has not been calibrated!\n", port);
+  double slope = (double)(tsc[1] - tsc[0]) / (ns[1] - ns[0]); // TSC cycles per nanosecond of the clock of the port
+  for (uint64_t i = 0; i < num_timestamps; i++)
+  {
+    if (!ts[i])
+      continue; // the frame was lost
+    if (hw_ts[i])
+    {
+      int64_t hw = (int64_t)tsc[0] + (int64_t)(slope * (int64_t)(hw_ts[i] - ns[0]));
+      if (hw > 0 && hw - (int64_t)ts[i] <= max_diff && (int64_t)ts[i] - hw <= max_diff)
+      {
+        ts[i] = hw;
+        continue;
+      }
+    }
+    kept++;
+  }
+  if (kept)
+    printf("Warning: %s %s timestamps: the software timestamps of %lu frames were kept (no matching hardware timestamp)\n", direction, kind, kept);
+  else
+    printf("Info: %s %s timestamps are hardware timestamps\n", direction, kind);
+}
@@ -0,0 +1,80 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMESTAMP_H_INCLUDED
+#define TIMESTAMP_H_INCLUDED
+
+// Hardware timestamps of the NICs (optional, maptperf-lat and maptperf-pdv only, see 'HW-timestamp' in the configuration file)
+//
+// The software timestamps (rte_rdtsc() after rte_eth_tx_burst() and after rte_eth_rx_burst()) contain the delay of the
+// TX and RX rings and of the processing of the bursts. If a port supports them, hardware timestamps are used instead:
+//   RX: the timestamp of the received frames (DEV_RX_OFFLOAD_TIMESTAMP), taken by the NIC in the time base of its
+//       IEEE 1588 clock (in nanoseconds)
+//   TX: the IEEE 1588 TX timestamp of the Latency Frames (PKT_TX_IEEE1588_TMST), read by the sender after the transmission
+//       of each Latency Frame. The NIC latches the timestamp of a single frame at a time, thus it can not be used for the
+//       PDV Frames (every frame is a PDV Frame), they keep their software TX timestamps. For the same reason, it is not
+//       used by the Senders of a port with several Senders (the latch is shared by all the TX queues of the port).
+// The hardware timestamps are stored next to the software ones, and they are converted into the TSC domain after the test
+// by a linear map fitted to two calibration points of the clock of the port (one before the test, and one after it),
+// so that the drift of the NIC clock is also compensated. A calibration point is the fastest of HW_TS_SAMPLES readings of
+// the clock of the port, and its TSC value is the midpoint of the reading.
+// A hardware timestamp is used only if it is within HW_TS_MAX_DIFF microseconds of the software timestamp of the same
+// frame, otherwise (e.g. if the PMD uses a different time base for the RX timestamps) the software timestamp is kept.
+
+#define HW_TS_SAMPLES 32    // the number of readings of the clock of a port at a calibration point
+#define HW_TS_TX_POLL 100   // the maximum time to wait for the TX timestamp of a Latency Frame (in microseconds)
+#define HW_TS_MAX_DIFF 1000 // the maximum difference between the hardware and software timestamps of a frame (in microseconds)
+
+// the IEEE 1588 clock of a port and its mapping into the TSC domain
+class HwClock
+{
+public:
+  HwClock(uint16_t port_, uint64_t hz_);
+  void calibrate(); // adds a calibration point (the first one before the test, the second one after it)
+  void convert(uint64_t *ts, const uint64_t *hw_ts, uint64_t num_timestamps, const char *kind, const char *direction);
+
+private:
+  uint16_t port;      // the port of the clock
+  uint64_t hz;        // the frequency of the TSC
+  int num_points;     // the number of calibration points so far
+  uint64_t tsc[2];    // the TSC values of the calibration points
+  uint64_t ns[2];     // the clock values of the calibration points (in nanoseconds)
+};
+
+// drops the TX timestamp latched by the port (if any), thus it can not be mistaken for that of the next Latency Frame
+inline void discardTxTimestamp(uint16_t port)
+{
+  struct timespec ts;
+  rte_eth_timesync_read_tx_timestamp(port, &ts);
+}
+
+// reads the TX timestamp of the frame sent last by the port (in nanoseconds), or returns 0, if it is not available in HW_TS_TX_POLL microseconds
+inline uint64_t readTxTimestamp(uint16_t port, uint64_t hz)
+{
+  struct timespec ts;
+  uint64_t deadline = rte_rdtsc() + hz * HW_TS_TX_POLL / 1000000;
+  do
+    if (rte_eth_timesync_read_tx_timestamp(port, &ts) == 0)
+      return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+  while (rte_rdtsc() < deadline);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "defines.h"
+#include "includes.h"
+#include "throughput.h"
+#include "classifier.h"
+#include "eatable.h"
+#include "validator.h"
+
+// builds the expectation table of a direction from its CE array (see buildCEArray())
+// The tables are allocated in the memory of the NUMA node of the receivers of the direction.
+Validator::Validator(bool forward_, CE_data *CE_array, uint32_t num_of_CEs, uint32_t bmr_ipv4_prefix_, uint8_t bmr_ipv4_suffix_length_, uint8_t psid_length_,
+                     uint32_t tester_r_ipv4_, struct in6_addr *dmr_ipv6_, struct in6_addr *tester_l_ipv6, struct in6_addr *tester_r_ipv6, int socket_id)
+{
+  const char *direction = forward_ ? "forward" : "reverse";
+  uint8_t ea_length = bmr_ipv4_suffix_length_ + psid_length_; // the number of EA-bits
+  uint64_t ea_mask = (((uint64_t)1) << ea_length) - 1;
+
+  if (!CE_array)
+    rte_exit(EXIT_FAILURE, "Validator(): a NULL pointer to the array of CEs data in the %s direction!\n", direction);
+  forward = forward_;
+  suffix_mask = (uint32_t)((((uint64_t)1) << bmr_ipv4_suffix_length_) - 1);
+  bmr_ipv4_prefix = ntohl(bmr_ipv4_prefix_) & ~suffix_mask;
+  psid_length = psid_length_;
+  psid_shift = 16 - psid_length_;
+  tester_r_ipv4 = tester_r_ipv4_;
+  dmr_ipv6 = *dmr_ipv6_;
+  bg_src = forward ? *tester_l_ipv6 : *tester_r_ipv6;
+  bg_dst = forward ? *tester_r_ipv6 : *tester_l_ipv6;
+
+  // the CEs may share their IPv4 suffixes, thus there are at most as many suffixes as CEs
+  suffixes = new EATable(num_of_CEs, UINT32_MAX, socket_id, "validator suffixes", direction);
+  eas = new EATable(num_of_CEs, UINT32_MAX, socket_id, "validator EA-bits", direction);
+  for (uint32_t i = 0; i < num_of_CEs; i++)
+  {
+    uint32_t suffix = ntohl(CE_array[i].ipv4_addr) & suffix_mask;
+    suffixes->insert(suffix, i);
+    eas->insert(((uint64_t)suffix) << psid_length | CE_array[i].psid, i);
+  }
+  // the upper 64 bits of the MAP addresses differ only in their EA-bits (the lowest bits)
+  map_prefix = 0;
+  for (int j = 0; j < 8; j++)
+    map_prefix = map_prefix << 8 | CE_array[0].map_addr.s6_addr[j];
+  map_prefix &= ~ea_mask;
+}
+
+Validator::~Validator()
+{
+  delete suffixes;
+  delete eas;
+}
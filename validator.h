@@ -0,0 +1,145 @@
+/* Maptperf is an RFC 8219 compliant MAP-T BR tester written in C++ using DPDK
+ *
+ *  Copyright (C) 2023 Ahmed Al-hamadani & Gabor Lencse
+ *
+ *  This file is part of Maptperf.
+ *
+ *  Maptperf is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Maptperf is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Maptperf.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VALIDATOR_H_INCLUDED
+#define VALIDATOR_H_INCLUDED
+
+// Translation validator of the receivers (optional, see 'Validate' in the configuration file)
+//
+// The headers of the received Test Frames are checked against the expected result of the translation by the DUT:
+//   forward (IPv6 --> IPv4): the source address must be the IPv4 address of a simulated CE (derived from its MAP address),
+//     the source port must be in the port set of that CE, and the destination address must be the IPv4 address of the
+//     Tester extracted from the DMR IPv6 address (RFC 6052)
+//   reverse (IPv4 --> IPv6): the source address must be the IPv4 address of the Tester embedded into the DMR prefix (RFC 6052),
+//     the destination address must be the MAP address of a simulated CE, and the destination port must be in its port set
+// The background frames are not translated, they are recognized by their addresses, and they are not checked.
+// Test Frames arriving with the same IP version as they were sent are counted as untranslated frames.
+//
+// The expectation tables are built from the CE array: they are hash tables of the EA-bits combinations (IPv4 suffix, PSID)
+// of the simulated CEs and of their IPv4 suffixes (see eatable.h). Their size depends on NUM-OF-CEs only, so any EA length
+// can be validated. The EA-bits combinations of a burst are prefetched before its frames are checked, and the check of
+// a correct frame needs a single lookup (the suffixes are looked up only to categorize the mismatches of the forward
+// direction), so that it can keep up with the receivers.
+// The MAP addresses are checked by their structure: the Interface ID contains the IPv4 address and the PSID of the CE,
+// and the upper 64 bits are the common prefix bits of the MAP addresses of the CE array plus the EA-bits (see buildCEArray()).
+// The mismatches are counted by category in the counters of the receiver.
+
+class Validator
+{
+public:
+  Validator(bool forward_, CE_data *CE_array, uint32_t num_of_CEs, uint32_t bmr_ipv4_prefix_, uint8_t bmr_ipv4_suffix_length_, uint8_t psid_length_,
+            uint32_t tester_r_ipv4_, struct in6_addr *dmr_ipv6_, struct in6_addr *tester_l_ipv6, struct in6_addr *tester_r_ipv6, int socket_id);
+  ~Validator();
+
+  // checks the translation of the Test Frames of a burst, whose bit masks are given by classifyBurst() (see classifier.h)
+  inline void check(struct rte_mbuf **pkt_mbufs, RxMasks test, struct rxCounters *counters)
+  {
+    uint32_t translated = forward ? test.ipv4 : test.ipv6; // the frames of the other IP version were not translated
+    uint32_t other = forward ? test.ipv6 : test.ipv4;
+    for (uint32_t frames = translated; frames; frames &= frames - 1)
+      eas->prefetch(frameEA(rte_pktmbuf_mtod(pkt_mbufs[__builtin_ctz(frames)], const uint8_t *)));
+    for (; translated; translated &= translated - 1)
+    {
+      const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[__builtin_ctz(translated)], const uint8_t *);
+      if (forward)
+        checkIPv4(pkt, counters);
+      else
+        checkIPv6(pkt, counters);
+    }
+    for (; other; other &= other - 1)
+    {
+      const uint8_t *pkt = rte_pktmbuf_mtod(pkt_mbufs[__builtin_ctz(other)], const uint8_t *);
+      if (forward && isBackground(pkt))
+        continue;
+      counters->untranslated++;
+    }
+  }
+
+private:
+  // the EA-bits combination of a translated frame (the source address and port in the forward direction,
+  // and the Interface ID of the destination address in the reverse direction, see below)
+  inline uint64_t frameEA(const uint8_t *pkt)
+  {
+    if (forward)
+      return (uint64_t)(rte_be_to_cpu_32(*(const uint32_t *)&pkt[26]) & suffix_mask) << psid_length | rte_be_to_cpu_16(*(const uint16_t *)&pkt[34]) >> psid_shift;
+    uint64_t iid = rte_be_to_cpu_64(*(const uint64_t *)&pkt[46]);
+    return (uint64_t)((uint32_t)(iid >> 16) & suffix_mask) << psid_length | (iid & 0xffff);
+  }
+
+  // checks an IPv4 frame (forward direction)
+  // Offsets from the start of the Ethernet Frame: source address: 14+12=26, destination address: 14+16=30, source port: 14+20=34
+  inline void checkIPv4(const uint8_t *pkt, struct rxCounters *counters)
+  {
+    uint32_t src = rte_be_to_cpu_32(*(const uint32_t *)&pkt[26]);
+    uint32_t suffix = src & suffix_mask;
+    uint64_t ea = (uint64_t)suffix << psid_length | rte_be_to_cpu_16(*(const uint16_t *)&pkt[34]) >> psid_shift; // the port set of the source port
+    if ((src & ~suffix_mask) != bmr_ipv4_prefix)
+      counters->bad_src++;
+    else if (!eas->contains(ea))
+    {
+      if (!suffixes->contains(suffix))
+        counters->bad_src++;
+      else
+        counters->bad_port++;
+    }
+    if (*(const uint32_t *)&pkt[30] != tester_r_ipv4)
+      counters->bad_dst++;
+  }
+
+  // checks an IPv6 frame (reverse direction), if it is not a background frame
+  // Offsets from the start of the Ethernet Frame: source address: 14+8=22, destination address: 14+24=38, destination port: 14+40+2=56
+  inline void checkIPv6(const uint8_t *pkt, struct rxCounters *counters)
+  {
+    if (isBackground(pkt))
+      return;
+    uint64_t upper = rte_be_to_cpu_64(*(const uint64_t *)&pkt[38]); // the upper 64 bits of the MAP address
+    uint64_t iid = rte_be_to_cpu_64(*(const uint64_t *)&pkt[46]);   // the Interface ID: 16 zero bits, IPv4 address, PSID
+    uint32_t ipv4 = (uint32_t)(iid >> 16);
+    uint32_t psid = (uint32_t)(iid & 0xffff);
+    uint32_t suffix = ipv4 & suffix_mask;
+    uint64_t ea = (uint64_t)suffix << psid_length | psid;
+    if (memcmp(&pkt[22], &dmr_ipv6, 16))
+      counters->bad_src++;
+    if (iid >> 48 || (ipv4 & ~suffix_mask) != bmr_ipv4_prefix || psid >> psid_length || !eas->contains(ea) || upper != (map_prefix | ea))
+      counters->bad_dst++;
+    else if ((uint32_t)(rte_be_to_cpu_16(*(const uint16_t *)&pkt[56]) >> psid_shift) != psid)
+      counters->bad_port++;
+  }
+
+  // background frames are sent between the IPv6 addresses of the Tester
+  inline bool isBackground(const uint8_t *pkt)
+  {
+    return !memcmp(&pkt[22], &bg_src, 16) && !memcmp(&pkt[38], &bg_dst, 16);
+  }
+
+  bool forward;                  // test direction (the received frames are IPv4 frames in the forward direction)
+  uint32_t bmr_ipv4_prefix;      // the IPv4 prefix of the CEs (in host byte order)
+  uint32_t suffix_mask;          // the IPv4 suffix bits of the CE addresses
+  uint8_t psid_length;           // the number of PSID bits
+  uint8_t psid_shift;            // the PSID of a port number is port >> psid_shift
+  EATable *suffixes;             // the IPv4 suffixes of the simulated CEs
+  EATable *eas;                  // the EA-bits combinations (suffix << psid_length | psid) of the simulated CEs
+  uint64_t map_prefix;           // the upper 64 bits of the MAP addresses without the EA-bits
+  uint32_t tester_r_ipv4;        // the expected IPv4 destination address in the forward direction (in network byte order)
+  struct in6_addr dmr_ipv6;      // the expected IPv6 source address in the reverse direction
+  struct in6_addr bg_src, bg_dst; // the addresses of the background frames
+};
+
+#endif